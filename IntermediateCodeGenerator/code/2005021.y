@@ -2,11 +2,18 @@
 	#include<iostream>
 	#include<fstream>
 	#include <sstream>
+	#include <atomic>
+	#include <chrono>
+	#include <filesystem>
+	#include <map>
+	#include <thread>
+	#include <vector>
 }
 
 %code requires {
 	#include "lex_utils.h"
 	#include "ast_utils.h"
+	#include "token_utils.h"
 }
 
 %union
@@ -21,34 +28,42 @@
 
 %code provides {
 	#define YY_DECL\
-  		yytoken_kind_t yylex (YYSTYPE* yylval, YYLTYPE* yylloc)
+  		yytoken_kind_t scanToken (YYSTYPE* yylval, YYLTYPE* yylloc, yyscan_t yyscanner)
   	YY_DECL;
 
+  	yytoken_kind_t yylex (YYSTYPE* yylval, YYLTYPE* yylloc);
+  	void beginScan (FILE* input, int lexThreads, bool pipeline);
+  	void endScan ();
+
   	void yyerror (const YYLTYPE *loc, string msg);
 }
 
 %code{
 	using namespace std;
 
-	extern FILE* yyin;
-	ofstream errorFile;
-	ofstream parseTreeFile;
-	ofstream logFile;
+	// Everything a compilation touches is per thread, so batch mode can run
+	// several compilations in one process
+	thread_local ofstream errorFile;
+	thread_local ofstream parseTreeFile;
+	thread_local ofstream logFile;
 
-	AST *ast;
-	SymbolTable *symbolTable;
-	VariableList *parameterList;
-	VariableList *variableList;
-	FunctionInfo *currentFunctionInfo;
-	int funcStackOffset;
+	thread_local AST *ast;
+	thread_local SymbolTable *symbolTable;
+	thread_local VariableList *parameterList;
+	thread_local VariableList *variableList;
+	thread_local FunctionInfo *currentFunctionInfo;
+	thread_local int funcStackOffset;
 
-	int totalLines = 0, totalErrors = 0;
+	thread_local int totalLines = 0, totalErrors = 0;
+	thread_local bool streamCode = false;
+	thread_local bool boundedMemory = false;
 
 	void writeError(string msg);
 	void writeLog(string msg);
 }
 
 %define api.pure full
+%define api.push-pull both
 %define api.token.prefix {TOKEN_}
 
 %token <symbolInfoPtr> IF ELSE FOR WHILE INT FLOAT VOID RETURN
@@ -74,58 +89,89 @@
 %%
 
 start : program {
-		string rule = "start : program";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild($1);
+		NodeKind kind = NodeKind::START;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild($1);
 		writeLog("start : program " );
 		ast->setRoot($$);
 	}
 ;
 
 program : program unit {
-		string rule = "program : program unit";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild($1)->addChild($2);
+		NodeKind kind = NodeKind::PROGRAM_APPEND;
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
+		if(boundedMemory){
+			delete $1;
+			delete $2;
+			symbolTable->deleteRetiredScopes();
+		} else {
+			$$->addChild($1)->addChild($2);
+		}
 		writeLog("program : program unit " ) ; 
 	}
 	| unit {
-		string rule = "program : unit";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild($1);
+		NodeKind kind = NodeKind::PROGRAM_FIRST;
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
+		if(boundedMemory){
+			delete $1;
+			symbolTable->deleteRetiredScopes();
+		} else {
+			$$->addChild($1);
+		}
 		writeLog("program : unit "  ) ; 
 	}
 ;
 
 unit : func_declaration {
-		string rule = "unit : func_declaration";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild($1);
+		NodeKind kind = NodeKind::UNIT_FUNC_DECLARATION;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild($1);
 		writeLog("unit : func_declaration ");
+		if(streamCode){
+			ast->generateUnitCode($$, symbolTable);
+		}
+		if(boundedMemory){
+			ast->printTree(parseTreeFile, $$, 0);
+		}
 	}
 	| func_definition {
-		string rule = "unit : func_definition";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild($1);
+		NodeKind kind = NodeKind::UNIT_FUNC_DEFINITION;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild($1);
 		writeLog("unit : func_definition  ");
+		if(streamCode){
+			ast->generateUnitCode($$, symbolTable);
+		}
+		if(boundedMemory){
+			ast->printTree(parseTreeFile, $$, 0);
+		}
 	}
 	| var_declaration {
-		string rule = "unit : var_declaration";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild($1);
+		NodeKind kind = NodeKind::UNIT_VAR_DECLARATION;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild($1);
 		writeLog("unit : var_declaration  " );
+		if(streamCode){
+			ast->generateUnitCode($$, symbolTable);
+		}
+		if(boundedMemory){
+			ast->printTree(parseTreeFile, $$, 0);
+		}
 	}
 ;
 
 func_declaration : type_specifier ID LPAREN parameter_list RPAREN SEMICOLON {
-		string rule = "func_declaration : type_specifier ID LPAREN parameter_list RPAREN SEMICOLON";
+		NodeKind kind = NodeKind::FUNC_DECLARATION_PARAMS;
 
 		FunctionInfo *functionInfo = new FunctionInfo($2->getName(), $1->getTypeSpecifier(), parameterList);
 		parameterList = new VariableList();
 
-		$$ = new ASTFunctionNode(rule, functionInfo, @$.first_line, @$.last_line);
+		$$ = new ASTFunctionNode(kind, functionInfo, @$.first_line, @$.last_line);
 		$$->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line))->addChild(new ASTLeafNode($3, @3.first_line))->addChild($4)->addChild(new ASTLeafNode($5, @5.first_line))->addChild(new ASTLeafNode($6, @6.first_line));
 
-		SymbolInfo* symbolInfo = symbolTable->LookUp($2->getName());
+		SymbolInfo* symbolInfo = symbolTable->LookUp($2->getName(), $2->getNameHash());
 		if(symbolInfo == nullptr){
 			symbolTable->Insert(functionInfo);
-		} else if(symbolInfo->getType() == "VARIABLE"){
+		} else if(symbolInfo->getKind() == SymbolKind::VARIABLE){
 			string errorMsg = "Line# " + to_string(@2.first_line) + ": '" + symbolInfo->getName() + "' redeclared as different kind of symbol";
 			writeError(errorMsg);
-		} else if(symbolInfo->getType() == "FUNCTION" && !functionInfo->isCompatibleWith((FunctionInfo*)symbolInfo)){
+		} else if(symbolInfo->getKind() == SymbolKind::FUNCTION && !functionInfo->isCompatibleWith((FunctionInfo*)symbolInfo)){
 			string errorMsg = "Line# " + to_string(@2.first_line) + ": Conflicting types for '" + symbolInfo->getName() + "'";
 			writeError(errorMsg);
 		} else{
@@ -135,17 +181,17 @@ func_declaration : type_specifier ID LPAREN parameter_list RPAREN SEMICOLON {
 		writeLog("func_declaration : type_specifier ID LPAREN parameter_list RPAREN SEMICOLON ");
 	}
 	| type_specifier ID LPAREN RPAREN SEMICOLON {
-		string rule = "func_declaration : type_specifier ID LPAREN RPAREN SEMICOLON";
+		NodeKind kind = NodeKind::FUNC_DECLARATION;
 
 		FunctionInfo *functionInfo = new FunctionInfo($2->getName(), $1->getTypeSpecifier());
 
-		SymbolInfo* symbolInfo = symbolTable->LookUp($2->getName());
+		SymbolInfo* symbolInfo = symbolTable->LookUp($2->getName(), $2->getNameHash());
 		if(symbolInfo == nullptr){
 			symbolTable->Insert(functionInfo);
-		} else if(symbolInfo->getType() == "VARIABLE"){
+		} else if(symbolInfo->getKind() == SymbolKind::VARIABLE){
 			string errorMsg = "Line# " + to_string(@2.first_line) + ": '" + symbolInfo->getName() + "' redeclared as different kind of symbol";
 			writeError(errorMsg);
-		} else if(symbolInfo->getType() == "FUNCTION" && !functionInfo->isCompatibleWith((FunctionInfo*)symbolInfo)){
+		} else if(symbolInfo->getKind() == SymbolKind::FUNCTION && !functionInfo->isCompatibleWith((FunctionInfo*)symbolInfo)){
 			string errorMsg = "Line# " + to_string(@2.first_line) + ": Conflicting types for '" + symbolInfo->getName() + "'";
 			writeError(errorMsg);
 		} else{
@@ -153,7 +199,7 @@ func_declaration : type_specifier ID LPAREN parameter_list RPAREN SEMICOLON {
 			writeError(errorMsg);
 		}
 
-		$$ = new ASTFunctionNode(rule, functionInfo, @$.first_line, @$.last_line);
+		$$ = new ASTFunctionNode(kind, functionInfo, @$.first_line, @$.last_line);
 		$$->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line))->addChild(new ASTLeafNode($3, @3.first_line))->addChild(new ASTLeafNode($4, @4.first_line))->addChild(new ASTLeafNode($5, @5.first_line));
 		writeLog("func_declaration : type_specifier ID LPAREN RPAREN SEMICOLON ");
 	}
@@ -162,17 +208,17 @@ func_declaration : type_specifier ID LPAREN parameter_list RPAREN SEMICOLON {
 func_definition : type_specifier ID LPAREN parameter_list RPAREN {
 		FunctionInfo *functionInfo = new FunctionInfo($2->getName(), $1->getTypeSpecifier(), parameterList);
 
-		SymbolInfo* symbolInfo = symbolTable->LookUp($2->getName());
+		SymbolInfo* symbolInfo = symbolTable->LookUp($2->getName(), $2->getNameHash());
 
 		 if(symbolInfo == nullptr){
 			functionInfo -> setDefined();
 			symbolTable->Insert(functionInfo);
 		}
-		else if(symbolInfo->getType() == "VARIABLE"){
+		else if(symbolInfo->getKind() == SymbolKind::VARIABLE){
 			string errorMsg = "Line# " + to_string(@2.first_line) + ": '" + symbolInfo->getName() + "' redeclared as different kind of symbol";
 			writeError(errorMsg);
 		}
-		else if(symbolInfo->getType() == "FUNCTION"){
+		else if(symbolInfo->getKind() == SymbolKind::FUNCTION){
 			FunctionInfo *tmpFunctionInfo = (FunctionInfo*)symbolInfo;
 			if(tmpFunctionInfo->isDefined()){
 				string errorMsg = "Line# " + to_string(@2.first_line) + ": Multiple definition of '" + tmpFunctionInfo->getName() + "'";
@@ -198,21 +244,19 @@ func_definition : type_specifier ID LPAREN parameter_list RPAREN {
 		int paramOffset = 0;
 		int paramCount = 0;
 		if(parameterList != nullptr){
-			VariableInfo *parameterListIterator = parameterList->getHead();
-			while(parameterListIterator != nullptr){
-				VariableInfo *tmpVariableInfo = new VariableInfo(parameterListIterator->getName(), parameterListIterator->getTypeSpecifier());
+			for(VariableInfo *parameter : parameterList->getVariables()){
+				VariableInfo *tmpVariableInfo = new VariableInfo(parameter->getName(), parameter->getTypeSpecifier());
 				tmpVariableInfo->setScopeId(symbolTable->getCurrentScopeTableId());
 				paramOffset += 2;
 				tmpVariableInfo->setParamOffset(paramOffset);
 				paramCount++;
 				bool isInserted = symbolTable->Insert(tmpVariableInfo);
 				if(! isInserted) break;
-				parameterListIterator = (VariableInfo*)(parameterListIterator->nestSymbolInfo);
 			}
 		}
 		functionInfo->setParameterCount(paramCount);
 	} compound_statement {
-		string rule = "func_definition : type_specifier ID LPAREN parameter_list RPAREN compound_statement";
+		NodeKind kind = NodeKind::FUNC_DEFINITION_PARAMS;
 
 		parameterList = new VariableList();
 
@@ -222,24 +266,24 @@ func_definition : type_specifier ID LPAREN parameter_list RPAREN {
 			writeError(errorMsg);
 		}
 		currentFunctionInfo->setFuncStackOffset(funcStackOffset);
-		$$ = new ASTFunctionNode(rule, currentFunctionInfo, @$.first_line, @$.last_line);
+		$$ = new ASTFunctionNode(kind, currentFunctionInfo, @$.first_line, @$.last_line);
 		$$->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line))->addChild(new ASTLeafNode($3, @3.first_line))->addChild($4)->addChild(new ASTLeafNode($5, @5.first_line))->addChild($7);
 		
 	}
 	| type_specifier ID LPAREN RPAREN {
 		FunctionInfo *functionInfo = new FunctionInfo($2->getName(), $1->getTypeSpecifier());
 		
-		SymbolInfo* symbolInfo = symbolTable->LookUp($2->getName());
+		SymbolInfo* symbolInfo = symbolTable->LookUp($2->getName(), $2->getNameHash());
 
 		if(symbolInfo == nullptr){
 			functionInfo -> setDefined();
 			symbolTable->Insert(functionInfo);
 		}
-		else if(symbolInfo->getType() == "VARIABLE"){
+		else if(symbolInfo->getKind() == SymbolKind::VARIABLE){
 			string errorMsg = "Line# " + to_string(@2.first_line) + ": '" + symbolInfo->getName() + "' redeclared as different kind of symbol";
 			writeError(errorMsg);
 		}
-		else if(symbolInfo->getType() == "FUNCTION"){
+		else if(symbolInfo->getKind() == SymbolKind::FUNCTION){
 			FunctionInfo *tmpFunctionInfo = (FunctionInfo*)symbolInfo;
 			if(tmpFunctionInfo->isDefined()){
 				string errorMsg = "Line# " + to_string(@2.first_line) + ": Multiple definition of '" + tmpFunctionInfo->getName() + "'";
@@ -264,11 +308,11 @@ func_definition : type_specifier ID LPAREN parameter_list RPAREN {
 		symbolTable->EnterScope();
 
 	} compound_statement {
-		string rule = "func_definition : type_specifier ID LPAREN RPAREN compound_statement";
+		NodeKind kind = NodeKind::FUNC_DEFINITION;
 
 		currentFunctionInfo->setFuncStackOffset(funcStackOffset);
 
-		$$ = new ASTFunctionNode(rule, currentFunctionInfo, @$.first_line, @$.last_line);
+		$$ = new ASTFunctionNode(kind, currentFunctionInfo, @$.first_line, @$.last_line);
 		$$->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line))->addChild(new ASTLeafNode($3, @3.first_line))->addChild(new ASTLeafNode($4, @4.first_line))->addChild($6);
 
 		writeLog("func_definition : type_specifier ID LPAREN RPAREN compound_statement");
@@ -276,17 +320,17 @@ func_definition : type_specifier ID LPAREN parameter_list RPAREN {
 ;
 
 parameter_list : parameter_list COMMA type_specifier ID {
-		string rule = "parameter_list : parameter_list COMMA type_specifier ID";
+		NodeKind kind = NodeKind::PARAMETER_LIST_APPEND_ID;
 		VariableInfo *variableInfo = new VariableInfo($4->getName(), $3->getTypeSpecifier());
 
-		if(parameterList->findVariable($4->getName())){
+		if(parameterList->findVariable($4->getName(), $4->getNameHash())){
 			string errorMsg = "Line# " + to_string(@4.first_line) + ": Redefinition of parameter '" + $4->getName() + "'";
 			writeError(errorMsg);
 		}
-		$$ = new ASTVariableNode(rule, variableInfo, @$.first_line, @$.last_line);
+		$$ = new ASTVariableNode(kind, variableInfo, @$.first_line, @$.last_line);
 		if($1->isError()){
 			$$->setError();
-			$$->setRule("parameter_list : error");
+			$$->setKind(NodeKind::PARAMETER_LIST_ERROR);
 			delete $1;
 			delete $2;
 			delete $3;
@@ -298,13 +342,13 @@ parameter_list : parameter_list COMMA type_specifier ID {
 		}
 	}
 	| parameter_list COMMA type_specifier {
-		string rule = "parameter_list : parameter_list COMMA type_specifier";
+		NodeKind kind = NodeKind::PARAMETER_LIST_APPEND;
 		// VariableInfo *variableInfo = new VariableInfo(string(), $3->getTypeSpecifier());
 		VariableInfo *variableInfo = new VariableInfo("NN", $3->getTypeSpecifier());
-		$$ = new ASTVariableNode(rule, variableInfo, @$.first_line, @$.last_line);
+		$$ = new ASTVariableNode(kind, variableInfo, @$.first_line, @$.last_line);
 		if($1->isError()){
 			$$->setError();
-			$$->setRule("parameter_list : error");
+			$$->setKind(NodeKind::PARAMETER_LIST_ERROR);
 			delete $1;
 			delete $2;
 			delete $3;
@@ -315,41 +359,41 @@ parameter_list : parameter_list COMMA type_specifier ID {
 		}
 	}
 	| type_specifier ID {
-		string rule = "parameter_list : type_specifier ID";
+		NodeKind kind = NodeKind::PARAMETER_LIST_ID;
 		VariableInfo *variableInfo = new VariableInfo($2->getName(), $1->getTypeSpecifier());
 		parameterList->addVariable(variableInfo);
-		$$ = new ASTVariableNode(rule, variableInfo, @$.first_line, @$.last_line);
+		$$ = new ASTVariableNode(kind, variableInfo, @$.first_line, @$.last_line);
 		$$->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line));
 		writeLog("parameter_list  : type_specifier ID");
 	}
 	| type_specifier {
-		string rule = "parameter_list : type_specifier";
+		NodeKind kind = NodeKind::PARAMETER_LIST_TYPE;
 		// VariableInfo *variableInfo = new VariableInfo(string(), $1->getTypeSpecifier());
 		VariableInfo *variableInfo = new VariableInfo("NN", $1->getTypeSpecifier());
 		parameterList->addVariable(variableInfo);
-		$$ = new ASTVariableNode(rule, variableInfo, @$.first_line, @$.last_line);
+		$$ = new ASTVariableNode(kind, variableInfo, @$.first_line, @$.last_line);
 		$$->addChild($1);
 		writeLog("parameter_list  : type_specifier ");
 	}
 	| error {
-		string rule = "parameter_list : error";
-		$$ = new ASTVariableNode(rule, nullptr, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::PARAMETER_LIST_ERROR;
+		$$ = new ASTVariableNode(kind, nullptr, @$.first_line, @$.last_line);
 		$$->setError();
 		yyclearin;
 	}
 ;
 
 compound_statement : LCURL statements RCURL {
-		string rule = "compound_statement : LCURL statements RCURL";
-		$$ = new ASTInternalNode(rule, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::COMPOUND_STATEMENT;
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
 		$$->addChild(new ASTLeafNode($1, @1.first_line))->addChild($2)->addChild(new ASTLeafNode($3, @3.first_line));
 		writeLog("compound_statement : LCURL statements RCURL  ");
 		logFile << symbolTable->PrintAllScopeTable();
 		symbolTable->ExitScope();
 	}
 	| LCURL RCURL {
-		string rule = "compound_statement : LCURL RCURL";
-		$$ = new ASTInternalNode(rule, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::COMPOUND_STATEMENT_EMPTY;
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
 		$$->addChild(new ASTLeafNode($1, @1.first_line))->addChild(new ASTLeafNode($2, @2.first_line));
 		writeLog("compound_statement : LCURL RCURL  ");
 		logFile << symbolTable->PrintAllScopeTable();
@@ -358,23 +402,22 @@ compound_statement : LCURL statements RCURL {
 ;
 
 var_declaration : type_specifier declaration_list SEMICOLON {
-		string rule = "var_declaration : type_specifier declaration_list SEMICOLON";
-		$$ = new ASTInternalNode(rule, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::VAR_DECLARATION;
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
 		$$->addChild($1)->addChild($2)->addChild(new ASTLeafNode($3, @3.first_line));
 		$$->setTypeSpecifier($1->getTypeSpecifier());
 
-		VariableInfo *variableListIterator = variableList->getHead();
-		if($1->getTypeSpecifier() == "VOID"){
-			string errorMsg = "Line# " + to_string(@1.first_line) + ": Variable or field '" + variableListIterator->getName() + "' declared void";
+		if($1->getTypeSpecifier() == TYPE_VOID){
+			string errorMsg = "Line# " + to_string(@1.first_line) + ": Variable or field '" + variableList->getVariable(0)->getName() + "' declared void";
 			writeError(errorMsg);
 		} else {
-			while(variableListIterator != nullptr){
-				SymbolInfo *symbolInfo = symbolTable->LookUpCurrentScope(variableListIterator->getName());
+			for(VariableInfo *variableListIterator : variableList->getVariables()){
+				SymbolInfo *symbolInfo = symbolTable->LookUpCurrentScope(variableListIterator->getName(), variableListIterator->getNameHash());
 				if(symbolInfo == nullptr){
 					variableListIterator->setTypeSpecifier($1->getTypeSpecifier());
 					symbolTable->Insert(variableListIterator);
 				}
-				else if (symbolInfo->getType() == "FUNCTION"){
+				else if (symbolInfo->getKind() == SymbolKind::FUNCTION){
 					string errorMsg = "Line# " + to_string(@1.first_line) + ": '" + symbolInfo->getName() + "' redeclared as different kind of symbol";
 					writeError(errorMsg);
 				}
@@ -388,54 +431,52 @@ var_declaration : type_specifier declaration_list SEMICOLON {
 						writeError(errorMsg);
 					}
 				}
-				VariableInfo *tmpVariableInfo = variableListIterator;
-				variableListIterator = (VariableInfo*)(variableListIterator->nestSymbolInfo);
-				tmpVariableInfo->nestSymbolInfo = nullptr;
 			}
 		}
 		if($2->isError()){
 			string errorMsg = "Line# " + to_string(@$.first_line) + ": Syntax error at declaration list of variable declaration";
 			writeError(errorMsg);
 		}
-		variableList = new VariableList();;
+		delete variableList;
+		variableList = new VariableList();
 		writeLog("var_declaration : type_specifier declaration_list SEMICOLON  ");
 	}
 ;
 
 type_specifier : INT {
-		string rule = "type_specifier : INT";
-		$$ = new ASTInternalNode(rule, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::TYPE_INT;
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
 		$$->addChild(new ASTLeafNode($1, @1.first_line));
-		$$->setTypeSpecifier("INT");
+		$$->setTypeSpecifier(TYPE_INT);
 		writeLog("type_specifier	: INT ");
 	}
 	| FLOAT {
-		string rule = "type_specifier : FLOAT";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line));
+		NodeKind kind = NodeKind::TYPE_FLOAT;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line));
 		$$->addChild(new ASTLeafNode($1, @1.first_line));
-		$$->setTypeSpecifier("FLOAT");
+		$$->setTypeSpecifier(TYPE_FLOAT);
 		writeLog("type_specifier	: FLOAT ");
 	}
 	| VOID {
-		string rule = "type_specifier : VOID";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line));
+		NodeKind kind = NodeKind::TYPE_VOID;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line));
 		$$->addChild(new ASTLeafNode($1, @1.first_line));
-		$$->setTypeSpecifier("VOID");
+		$$->setTypeSpecifier(TYPE_VOID);
 		writeLog("type_specifier	: VOID");
 	}
 ;
 
 declaration_list : declaration_list COMMA ID {
-		string rule = "declaration_list : declaration_list COMMA ID";
+		NodeKind kind = NodeKind::DECLARATION_LIST_APPEND_ID;
 		funcStackOffset += 2;
 		VariableInfo *variableInfo = new VariableInfo($3->getName());
 		variableInfo->setScopeId(symbolTable->getCurrentScopeTableId());
 		variableInfo->setOffset(funcStackOffset);
-		$$ = (new ASTVariableNode(rule, variableInfo, @$.first_line, @$.last_line, symbolTable->getCurrentScopeTableId()));
+		$$ = (new ASTVariableNode(kind, variableInfo, @$.first_line, @$.last_line, symbolTable->getCurrentScopeTableId()));
 
 		if($1->isError()){
 			$$->setError();
-			$$->setRule("declaration_list : error");
+			$$->setKind(NodeKind::DECLARATION_LIST_ERROR);
 			delete $1;
 			delete $2;
 			delete $3;
@@ -446,15 +487,15 @@ declaration_list : declaration_list COMMA ID {
 		}
 	}
 	| declaration_list COMMA ID LSQUARE CONST_INT RSQUARE {
-		string rule = "declaration_list : declaration_list COMMA ID LSQUARE CONST_INT RSQUARE";
+		NodeKind kind = NodeKind::DECLARATION_LIST_APPEND_ARRAY;
 		ArrayInfo *arrayInfo = new ArrayInfo($3->getName(), stoi($5->getName()));
 		arrayInfo->setScopeId(symbolTable->getCurrentScopeTableId());
 		funcStackOffset += 2 * arrayInfo->getArraySize();
 		arrayInfo->setOffset(funcStackOffset);
-		$$ = (new ASTVariableNode(rule, arrayInfo, @$.first_line, @$.last_line, symbolTable->getCurrentScopeTableId()));
+		$$ = (new ASTVariableNode(kind, arrayInfo, @$.first_line, @$.last_line, symbolTable->getCurrentScopeTableId()));
 		if($1->isError()){
 			$$->setError();
-			$$->setRule("declaration_list : error");
+			$$->setKind(NodeKind::DECLARATION_LIST_ERROR);
 			delete $1;
 			delete $2;
 			delete $3;
@@ -468,124 +509,125 @@ declaration_list : declaration_list COMMA ID {
 		}
 	}
 	| ID {
-		string rule = "declaration_list : ID";
+		NodeKind kind = NodeKind::DECLARATION_LIST_ID;
 		VariableInfo *variableInfo = new VariableInfo($1->getName());
 		variableInfo->setScopeId(symbolTable->getCurrentScopeTableId());
 		funcStackOffset += 2;
 		variableInfo->setOffset(funcStackOffset);
 		variableList->addVariable(variableInfo);
-		$$ = (new ASTVariableNode(rule, variableInfo, @$.first_line, @$.last_line, symbolTable->getCurrentScopeTableId()));
+		$$ = (new ASTVariableNode(kind, variableInfo, @$.first_line, @$.last_line, symbolTable->getCurrentScopeTableId()));
 		$$->addChild(new ASTLeafNode($1, @1.first_line));
 		writeLog("declaration_list : ID ");
 	}
 	| ID LSQUARE CONST_INT RSQUARE {
-		string rule = "declaration_list : ID LSQUARE CONST_INT RSQUARE";
+		NodeKind kind = NodeKind::DECLARATION_LIST_ARRAY;
 		ArrayInfo *arrayInfo = new ArrayInfo($1->getName(), stoi($3->getName()));
 		arrayInfo->setScopeId(symbolTable->getCurrentScopeTableId());
 		funcStackOffset += 2 * arrayInfo->getArraySize();
 		arrayInfo->setOffset(funcStackOffset);
 		variableList->addVariable(arrayInfo);
-		$$ = (new ASTVariableNode(rule, arrayInfo, @$.first_line, @$.last_line, symbolTable->getCurrentScopeTableId()));
+		$$ = (new ASTVariableNode(kind, arrayInfo, @$.first_line, @$.last_line, symbolTable->getCurrentScopeTableId()));
 		$$->addChild(new ASTLeafNode($1, @1.first_line))->addChild(new ASTLeafNode($2, @2.first_line))->addChild(new ASTLeafNode($3, @3.first_line))->addChild(new ASTLeafNode($4, @4.first_line));
 		writeLog("declaration_list : ID LSQUARE CONST_INT RSQUARE ");
 	}
 	| error {
-		string rule = "declaration_list : error";
-		$$ = new ASTVariableNode(rule, nullptr, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::DECLARATION_LIST_ERROR;
+		$$ = new ASTVariableNode(kind, nullptr, @$.first_line, @$.last_line);
 		$$->setError();
 		yyclearin;
 	}
 ;
 
 statements : statement {
-		string rule = "statements : statement";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line));
+		NodeKind kind = NodeKind::STATEMENTS_FIRST;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line));
 		$$->addChild($1);
 		writeLog("statements : statement  ");
 	}
 	| statements statement {
-		string rule = "statements : statements statement";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line));
+		NodeKind kind = NodeKind::STATEMENTS_APPEND;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line));
 		$$->addChild($1)->addChild($2);
 		writeLog("statements : statements statement  ");
 	}
 ;
 
 statement : var_declaration {
-		string rule = "statement : var_declaration";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line));
+		NodeKind kind = NodeKind::STATEMENT_VAR_DECLARATION;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line));
 		$$->addChild($1);
 		writeLog("statement : var_declaration ");
 	}
 	| expression_statement {
-		string rule = "statement : expression_statement";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line));
+		NodeKind kind = NodeKind::STATEMENT_EXPRESSION;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line));
 		$$->addChild($1);
 		writeLog("statement : expression_statement  ");
 	}
 	| {
 		symbolTable->EnterScope();
 	} compound_statement {
-		string rule = "statement : compound_statement";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line));
+		NodeKind kind = NodeKind::STATEMENT_COMPOUND;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line));
 		$$->addChild($2);
 		writeLog("statement : compound_statement ");
 	}
 	| FOR LPAREN expression_statement expression_statement expression RPAREN statement {
-		string rule = "statement : FOR LPAREN expression_statement expression_statement expression RPAREN statement";
-		$$ = new ASTInternalNode(rule, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::STATEMENT_FOR;
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
 		$$->addChild(new ASTLeafNode($1, @1.first_line))->addChild(new ASTLeafNode($2, @2.first_line))->addChild($3)->addChild($4)->addChild($5)->addChild(new ASTLeafNode($6, @6.first_line))->addChild($7);
 		writeLog("statement : FOR LPAREN expression_statement expression_statement expression RPAREN statement");
 	}
 	| IF LPAREN expression RPAREN statement {
-		string rule = "statement : IF LPAREN expression RPAREN statement";
-		$$ = new ASTInternalNode(rule, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::STATEMENT_IF;
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
 		$$->addChild(new ASTLeafNode($1, @1.first_line))->addChild(new ASTLeafNode($2, @2.first_line))->addChild($3)->addChild(new ASTLeafNode($4, @4.first_line))->addChild($5);
 		writeLog("statement : IF LPAREN expression RPAREN statement ");
 	}
 	| IF LPAREN expression RPAREN statement ELSE statement {
-		string rule = "statement : IF LPAREN expression RPAREN statement ELSE statement";
-		$$ = new ASTInternalNode(rule, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::STATEMENT_IF_ELSE;
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
 		$$->addChild(new ASTLeafNode($1, @1.first_line))->addChild(new ASTLeafNode($2, @2.first_line))->addChild($3)->addChild(new ASTLeafNode($4, @4.first_line))->addChild($5)->addChild(new ASTLeafNode($6, @6.first_line))->addChild($7);
 		writeLog("statement : IF LPAREN expression RPAREN statement ELSE statement ");
 	}
 	| WHILE LPAREN expression RPAREN statement {
-		string rule = "statement : WHILE LPAREN expression RPAREN statement";
-		$$ = new ASTInternalNode(rule, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::STATEMENT_WHILE;
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
 		$$->addChild(new ASTLeafNode($1, @1.first_line))->addChild(new ASTLeafNode($2, @2.first_line))->addChild($3)->addChild(new ASTLeafNode($4, @4.first_line))->addChild($5);
 		writeLog("statement : WHILE LPAREN expression RPAREN statement");
 	}
 	| PRINTLN LPAREN ID RPAREN SEMICOLON {
-		string rule = "statement : PRINTLN LPAREN ID RPAREN SEMICOLON";
-		SymbolInfo *symbolInfo = symbolTable->LookUp($3->getName());
+		NodeKind kind = NodeKind::STATEMENT_PRINTLN;
+		SymbolInfo *symbolInfo = symbolTable->LookUp($3->getName(), $3->getNameHash());
 
 		if(symbolInfo == nullptr){
 			string errorMsg = "Line# " + to_string(@3.first_line) + ": Undeclared variable";
 			writeError(errorMsg);
 		} else {
+			delete $3;
 			$3 = symbolInfo;
 		}
-		$$ = new ASTInternalNode(rule, @$.first_line, @$.last_line);
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
 		$$->addChild(new ASTLeafNode($1, @1.first_line))->addChild(new ASTLeafNode($2, @2.first_line))->addChild(new ASTLeafNode($3, @3.first_line))->addChild(new ASTLeafNode($4, @4.first_line))->addChild(new ASTLeafNode($5, @5.first_line));
 		writeLog("statement : PRINTLN LPAREN ID RPAREN SEMICOLON ");
 	}
 	| RETURN expression SEMICOLON {
-		string rule = "statement : RETURN expression SEMICOLON";
-		$$ = new ASTInternalNode(rule, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::STATEMENT_RETURN;
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
 		$$->addChild(new ASTLeafNode($1, @1.first_line))->addChild($2)->addChild(new ASTLeafNode($3, @3.first_line));
 		writeLog("statement : RETURN expression SEMICOLON");
 	}
 ;
 
 expression_statement : SEMICOLON {
-		string rule = "expression_statement : SEMICOLON";
-		$$ = new ASTInternalNode(rule, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::EXPRESSION_STATEMENT_EMPTY;
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
 		$$->addChild(new ASTLeafNode($1, @1.first_line));
 		writeLog("	expression_statement : SEMICOLON		");
 	}
 	| expression SEMICOLON {
-		string rule = "expression_statement : expression SEMICOLON";
-		$$ = new ASTInternalNode(rule, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::EXPRESSION_STATEMENT;
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
 		$$->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line));
 		$$->setTypeSpecifier($1->getTypeSpecifier());
 		writeLog("expression_statement : expression SEMICOLON 		 ");
@@ -597,54 +639,58 @@ expression_statement : SEMICOLON {
 ;
 
 variable : ID {
-		string rule = "variable : ID";
+		NodeKind kind = NodeKind::VARIABLE_ID;
 
 		VariableInfo *variableInfo = new VariableInfo($1->getName());
 
-		SymbolInfo *symbolInfo = symbolTable->LookUp($1->getName());
+		SymbolInfo *symbolInfo = symbolTable->LookUp($1->getName(), $1->getNameHash());
 		if(symbolInfo == nullptr){
 			string errorMsg = "Line# " + to_string(@1.first_line) + ": Undeclared variable '" + $1->getName() + "'";
 			writeError(errorMsg);
 		} else {
+			delete variableInfo;
 			variableInfo = (VariableInfo*)symbolInfo;
+			delete $1;
 			$1 = variableInfo;
 		}
-		$$ = new ASTVariableNode(rule, variableInfo, @$.first_line, @$.last_line);
+		$$ = new ASTVariableNode(kind, variableInfo, @$.first_line, @$.last_line);
 		$$->addChild(new ASTLeafNode($1, @1.first_line));
 		$$->setTypeSpecifier(variableInfo->getTypeSpecifier());
 		writeLog("variable : ID 	 ");
 	}
 	| ID LSQUARE expression RSQUARE {
-		string rule = "variable : ID LSQUARE expression RSQUARE";
+		NodeKind kind = NodeKind::VARIABLE_ARRAY;
 
 		VariableInfo *variableInfo = new VariableInfo($1->getName());
 
-		SymbolInfo *symbolInfo = symbolTable->LookUp($1->getName());
+		SymbolInfo *symbolInfo = symbolTable->LookUp($1->getName(), $1->getNameHash());
 		if(symbolInfo == nullptr){
 			string errorMsg = "Line# " + to_string(@1.first_line) + ": Undeclared variable '" + $1->getName() + "'";
 			writeError(errorMsg);
 		}
-		else if(symbolInfo->getType() == "FUNCTION"){
+		else if(symbolInfo->getKind() == SymbolKind::FUNCTION){
 			string errorMsg = "Line# " + to_string(@1.first_line) + ": '" + symbolInfo->getName() + "' redeclared as different kind of symbol";
 			writeError(errorMsg);
 		}
-		else if(symbolInfo->getType() == "VARIABLE"){
+		else if(symbolInfo->getKind() == SymbolKind::VARIABLE){
 			string errorMsg = "Line# " + to_string(@1.first_line) +  ": '" + symbolInfo->getName() + "' is not an array";
 			writeError(errorMsg);
 		}
 		else{
+			delete variableInfo;
 			variableInfo = (VariableInfo*)symbolInfo;
+			delete $1;
 			$1 = variableInfo;
 		}
 		if($3->isError()){
 			string errorMsg = "Line# " + to_string(@$.first_line) + ": Syntax error at expression of expression statement";
 			writeError(errorMsg);
-		} else if($3->getTypeSpecifier() != "INT"){
+		} else if($3->getTypeSpecifier() != TYPE_INT){
 			string errorMsg = "Line# " + to_string(@3.first_line) + ": Array subscript is not an integer";
 			writeError(errorMsg);
 		}
 
-		$$ = new ASTVariableNode(rule, variableInfo, @$.first_line, @$.last_line);
+		$$ = new ASTVariableNode(kind, variableInfo, @$.first_line, @$.last_line);
 		$$->addChild(new ASTLeafNode($1, @1.first_line))->addChild(new ASTLeafNode($2, @2.first_line))->addChild($3)->addChild(new ASTLeafNode($4, @4.first_line));
 		$$->setTypeSpecifier(variableInfo->getTypeSpecifier());
 		writeLog("variable : ID LSQUARE expression RSQUARE  	 ");
@@ -652,48 +698,48 @@ variable : ID {
 ;
 
 expression : logic_expression {
-		string rule = "expression : logic_expression";
-		$$ = new ASTInternalNode(rule, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::EXPRESSION_LOGIC;
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
 		$$->addChild($1);
 		$$->setTypeSpecifier($1->getTypeSpecifier());
 		writeLog("expression 	: logic_expression	 ");
 	}
 	| variable ASSIGNOP logic_expression {
-		string rule = "expression : variable ASSIGNOP logic_expression";
-		$$ = new ASTInternalNode(rule, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::EXPRESSION_ASSIGN;
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
 		$$->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line))->addChild($3);
 		$$->setTypeSpecifier($1->getTypeSpecifier());
 
-		if($3->getTypeSpecifier() == "VOID"){
+		if($3->getTypeSpecifier() == TYPE_VOID){
 			string errorMsg = "Line# " + to_string(@2.first_line) + ": Void cannot be used in expression ";
 			writeError(errorMsg);
 		}
-		else if($1->getTypeSpecifier() == "INT" && $3->getTypeSpecifier() == "FLOAT"){
+		else if($1->getTypeSpecifier() == TYPE_INT && $3->getTypeSpecifier() == TYPE_FLOAT){
 			string errorMsg = "Line# " + to_string(@2.first_line) + ": Warning: possible loss of data in assignment of FLOAT to INT";
 			writeError(errorMsg);
 		}
 		writeLog("expression 	: variable ASSIGNOP logic_expression 		 ");
 	}
 	| error {
-		string rule = "expression : error";
-		$$ = new ASTInternalNode(rule, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::EXPRESSION_ERROR;
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
 		$$->setError();
 		yyclearin;
 	}
 ;
 
 logic_expression : rel_expression {
-		string rule = "logic_expression : rel_expression";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild($1);
+		NodeKind kind = NodeKind::LOGIC_EXPRESSION_REL;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild($1);
 		$$->setTypeSpecifier($1->getTypeSpecifier());
 		writeLog("logic_expression : rel_expression 	 ");
 	}
 	| rel_expression LOGICOP rel_expression {
-		string rule = "logic_expression : rel_expression LOGICOP rel_expression";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line))->addChild($3);
-		$$->setTypeSpecifier("INT");
+		NodeKind kind = NodeKind::LOGIC_EXPRESSION_LOGICOP;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line))->addChild($3);
+		$$->setTypeSpecifier(TYPE_INT);
 
-		if($1->getTypeSpecifier() == "VOID" || $3->getTypeSpecifier() == "VOID"){
+		if($1->getTypeSpecifier() == TYPE_VOID || $3->getTypeSpecifier() == TYPE_VOID){
 			string errorMsg = "Line# " + to_string(@2.first_line) + ": cannot use logical operator on void type";
 			writeError(errorMsg);
 		}
@@ -702,16 +748,16 @@ logic_expression : rel_expression {
 ;
 
 rel_expression : simple_expression {
-		string rule = "rel_expression : simple_expression";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild($1);
+		NodeKind kind = NodeKind::REL_EXPRESSION_SIMPLE;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild($1);
 		$$->setTypeSpecifier($1->getTypeSpecifier());
 		writeLog("rel_expression	: simple_expression ");
 	}
 	| simple_expression RELOP simple_expression	{
-		string rule = "rel_expression : simple_expression RELOP simple_expression";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line))->addChild($3);
-		$$->setTypeSpecifier("INT");
-		if($1->getTypeSpecifier() == "VOID" || $3->getTypeSpecifier() == "VOID"){
+		NodeKind kind = NodeKind::REL_EXPRESSION_RELOP;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line))->addChild($3);
+		$$->setTypeSpecifier(TYPE_INT);
+		if($1->getTypeSpecifier() == TYPE_VOID || $3->getTypeSpecifier() == TYPE_VOID){
 			string errorMsg = "Line# " + to_string(@2.first_line) + ": cannot use relational operator on void type";
 			writeError(errorMsg);
 		}
@@ -720,43 +766,43 @@ rel_expression : simple_expression {
 ;
 
 simple_expression : term {
-		string rule = "simple_expression : term";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild($1);
+		NodeKind kind = NodeKind::SIMPLE_EXPRESSION_TERM;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild($1);
 		$$->setTypeSpecifier($1->getTypeSpecifier());
 		writeLog("simple_expression : term ");
 	}
 	| simple_expression ADDOP term {
-		string rule = "simple_expression : simple_expression ADDOP term";
+		NodeKind kind = NodeKind::SIMPLE_EXPRESSION_ADDOP;
 
-		if($1->getTypeSpecifier() == "VOID" || $3->getTypeSpecifier() == "VOID"){
+		if($1->getTypeSpecifier() == TYPE_VOID || $3->getTypeSpecifier() == TYPE_VOID){
 			string errorMsg = "Line# " + to_string(@2.first_line) + ": Void cannot be used in expression ";
 			writeError(errorMsg);
 		}
 		
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line))->addChild($3);
-		if($1->getTypeSpecifier() == "FLOAT" || $3->getTypeSpecifier() == "FLOAT"){
-			$$->setTypeSpecifier("FLOAT");
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line))->addChild($3);
+		if($1->getTypeSpecifier() == TYPE_FLOAT || $3->getTypeSpecifier() == TYPE_FLOAT){
+			$$->setTypeSpecifier(TYPE_FLOAT);
 		} else {
-			$$->setTypeSpecifier("INT");
+			$$->setTypeSpecifier(TYPE_INT);
 		}
 		writeLog("simple_expression : simple_expression ADDOP term  ");
 	}
 ;
 
 term : unary_expression {
-		string rule = "term : unary_expression";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild($1);
+		NodeKind kind = NodeKind::TERM_UNARY;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild($1);
 		$$->setTypeSpecifier($1->getTypeSpecifier());
 		writeLog("term :	unary_expression ");
 	}
 	| term MULOP unary_expression {
-		string rule = "term : term MULOP unary_expression";
+		NodeKind kind = NodeKind::TERM_MULOP;
 
-		if($1->getTypeSpecifier() == "VOID" || $3->getTypeSpecifier() == "VOID"){
+		if($1->getTypeSpecifier() == TYPE_VOID || $3->getTypeSpecifier() == TYPE_VOID){
 			string errorMsg = "Line# " + to_string(@2.first_line) + ": Void cannot be used in expression ";
 			writeError(errorMsg);
 		}
-		else if($2->getName() == "%" && ($1->getTypeSpecifier() != "INT" || $3->getTypeSpecifier() != "INT")){
+		else if($2->getName() == "%" && ($1->getTypeSpecifier() != TYPE_INT || $3->getTypeSpecifier() != TYPE_INT)){
 			string errorMsg = "Line# " + to_string(@2.first_line) + ": Operands of modulus must be integers ";
 			writeError(errorMsg);
 		}
@@ -767,41 +813,41 @@ term : unary_expression {
 			}
 		}
 		
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line))->addChild($3);
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line))->addChild($3);
 		if($2->getName() == "%"){
-			$$->setTypeSpecifier("INT");
-		} else if($1->getTypeSpecifier() == "FLOAT" || $3->getTypeSpecifier() == "FLOAT"){
-			$$->setTypeSpecifier("FLOAT");
+			$$->setTypeSpecifier(TYPE_INT);
+		} else if($1->getTypeSpecifier() == TYPE_FLOAT || $3->getTypeSpecifier() == TYPE_FLOAT){
+			$$->setTypeSpecifier(TYPE_FLOAT);
 		} else {
-			$$->setTypeSpecifier("INT");
+			$$->setTypeSpecifier(TYPE_INT);
 		}
 		writeLog("term :	term MULOP unary_expression ");
 	}
 ;
 
 unary_expression : ADDOP unary_expression {
-		string rule = "unary_expression : ADDOP unary_expression";
-		if($2->getTypeSpecifier() == "VOID"){
+		NodeKind kind = NodeKind::UNARY_EXPRESSION_ADDOP;
+		if($2->getTypeSpecifier() == TYPE_VOID){
 			string errorMsg = "Line# " + to_string(@1.first_line) + ": Void cannot be used in expression ";
 			writeError(errorMsg);
 		}
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild(new ASTLeafNode($1, @1.first_line))->addChild($2);
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild(new ASTLeafNode($1, @1.first_line))->addChild($2);
 		$$->setTypeSpecifier($2->getTypeSpecifier());
 		writeLog("unary_expression : ADDOP unary_expression ");
 	}
 	| NOT unary_expression {
-		string rule = "unary_expression : NOT unary_expression";
-		if($2->getTypeSpecifier() == "VOID"){
+		NodeKind kind = NodeKind::UNARY_EXPRESSION_NOT;
+		if($2->getTypeSpecifier() == TYPE_VOID){
 			string errorMsg = "Line# " + to_string(@1.first_line) + ": cannot use logical operator on void type";
 			writeError(errorMsg);
 		}
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild(new ASTLeafNode($1, @1.first_line))->addChild($2);
-		$$->setTypeSpecifier("INT");
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild(new ASTLeafNode($1, @1.first_line))->addChild($2);
+		$$->setTypeSpecifier(TYPE_INT);
 		writeLog("unary_expression : NOT unary_expression  ");
 	}
 	| factor {
-		string rule = "unary_expression : factor";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild($1);
+		NodeKind kind = NodeKind::UNARY_EXPRESSION_FACTOR;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild($1);
 		$$->setTypeSpecifier($1->getTypeSpecifier());
 		if($1->isZero()) $$->setZero();
 		writeLog("unary_expression : factor ") ;
@@ -809,25 +855,25 @@ unary_expression : ADDOP unary_expression {
 ;
 
 factor : variable {
-		string rule = "factor : variable";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild($1);
+		NodeKind kind = NodeKind::FACTOR_VARIABLE;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild($1);
 		$$->setTypeSpecifier($1->getTypeSpecifier());
 		writeLog("factor	: variable ");
 	}
 	| ID LPAREN argument_list RPAREN {
-		string rule = "factor : ID LPAREN argument_list RPAREN";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild(new ASTLeafNode($1, @1.first_line))->addChild(new ASTLeafNode($2, @2.first_line))->addChild($3)->addChild(new ASTLeafNode($4, @4.first_line));
+		NodeKind kind = NodeKind::FACTOR_CALL;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild(new ASTLeafNode($1, @1.first_line))->addChild(new ASTLeafNode($2, @2.first_line))->addChild($3)->addChild(new ASTLeafNode($4, @4.first_line));
 
-		SymbolInfo* symbolInfo = symbolTable->LookUp($1->getName());
+		SymbolInfo* symbolInfo = symbolTable->LookUp($1->getName(), $1->getNameHash());
 		if(symbolInfo == nullptr){
 			string errorMsg = "Line# " + to_string(@1.first_line) + ": Undeclared function '" + $1->getName() + "'";
 			writeError(errorMsg);
 		}
-		else if(symbolInfo->getType() == "VARIABLE"){
+		else if(symbolInfo->getKind() == SymbolKind::VARIABLE){
 			string errorMsg = "Line# " + to_string(@1.first_line) + ": '" + $1->getName() + "' is not a function";
 			writeError(errorMsg);
 		}
-		else if(symbolInfo->getType() == "FUNCTION"){
+		else if(symbolInfo->getKind() == SymbolKind::FUNCTION){
 			FunctionInfo *functionInfo = (FunctionInfo*)symbolInfo;
 			if(functionInfo->getParameterCount() > variableList->getSize()){
 				string errorMsg = "Line# " + to_string(@1.first_line) + ": Too few arguments to function '" + $1->getName() + "'";
@@ -838,17 +884,12 @@ factor : variable {
 				writeError(errorMsg);
 			}
 			else if(functionInfo->getParameterList() != nullptr && !functionInfo->getParameterList()->isEqualTo(variableList)){
-				VariableInfo *listIterator = variableList->getHead();
-				VariableInfo *variableListIterator = functionInfo->getParameterList()->getHead();
-				int argNo = 1;
-				while (listIterator != nullptr && variableListIterator != nullptr){
-					if (listIterator->getTypeSpecifier() != variableListIterator->getTypeSpecifier()){
+				VariableList *functionParameterList = functionInfo->getParameterList();
+				for (int argNo = 1; argNo <= variableList->getSize(); argNo++){
+					if (variableList->getVariable(argNo - 1)->getTypeSpecifier() != functionParameterList->getVariable(argNo - 1)->getTypeSpecifier()){
 						string errorMsg = "Line# " + to_string(@1.first_line) + ": Type mismatch for argument " + to_string(argNo) + " of '" + $1->getName() + "'";
 						writeError(errorMsg);
 					}
-					argNo++;
-					listIterator = (VariableInfo *)listIterator->nestSymbolInfo;
-					variableListIterator = (VariableInfo *)variableListIterator->nestSymbolInfo;
 				}
 			}
 			else if(!functionInfo->isDefined()){
@@ -859,88 +900,93 @@ factor : variable {
 				$$->setTypeSpecifier(functionInfo->getReturnType());
 			}
 		}
-		variableList = new VariableList();;
+		// The argument placeholders are only needed for the checks above
+		for(VariableInfo *argument : variableList->getVariables()){
+			delete argument;
+		}
+		delete variableList;
+		variableList = new VariableList();
 		writeLog("factor	: ID LPAREN argument_list RPAREN  ");
 	}
 	| LPAREN expression RPAREN {
-		string rule = "factor : LPAREN expression RPAREN";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild(new ASTLeafNode($1, @1.first_line))->addChild($2)->addChild(new ASTLeafNode($3, @3.first_line));
+		NodeKind kind = NodeKind::FACTOR_PARENTHESIZED;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild(new ASTLeafNode($1, @1.first_line))->addChild($2)->addChild(new ASTLeafNode($3, @3.first_line));
 		$$->setTypeSpecifier($2->getTypeSpecifier());
 		writeLog("factor	: LPAREN expression RPAREN   ");
 	}
 	| CONST_INT {
-		string rule = "factor : CONST_INT";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild(new ASTLeafNode($1, @1.first_line));
-		$$->setTypeSpecifier("INT");
+		NodeKind kind = NodeKind::FACTOR_CONST_INT;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild(new ASTLeafNode($1, @1.first_line));
+		$$->setTypeSpecifier(TYPE_INT);
 		if(stoi($1->getName()) == 0){
 			$$->setZero();
 		}
 		writeLog("factor	: CONST_INT   ");
 	}
 	| CONST_FLOAT {
-		string rule = "factor : CONST_FLOAT";
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild(new ASTLeafNode($1, @1.first_line));
-		$$->setTypeSpecifier("FLOAT");
+		NodeKind kind = NodeKind::FACTOR_CONST_FLOAT;
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild(new ASTLeafNode($1, @1.first_line));
+		$$->setTypeSpecifier(TYPE_FLOAT);
 		if(stof($1->getName()) == 0.0){
 			$$->setZero();
 		}
 		writeLog("factor	: CONST_FLOAT   ");
 	}
 	| variable INCOP {
-		string rule = "factor : variable INCOP";
-		if($1->getTypeSpecifier() != "INT"){
+		NodeKind kind = NodeKind::FACTOR_INCOP;
+		if($1->getTypeSpecifier() != TYPE_INT){
 			string errorMsg = "Line# " + to_string(@1.first_line) + ": Operands of increment operator must be integers";
 			writeError(errorMsg);
 		}
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line));
-		$$->setTypeSpecifier("INT");
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line));
+		$$->setTypeSpecifier(TYPE_INT);
 		writeLog("factor	: variable INCOP   ");
 	}
 	| variable DECOP {
-		string rule = "factor : variable DECOP";
-		if($1->getTypeSpecifier() != "INT"){
+		NodeKind kind = NodeKind::FACTOR_DECOP;
+		if($1->getTypeSpecifier() != TYPE_INT){
 			string errorMsg = "Line# " + to_string(@1.first_line) + ": Operands of decrement operator must be integers";
 			writeError(errorMsg);
 		}
-		$$ = (new ASTInternalNode(rule, @$.first_line, @$.last_line))->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line));
-		$$->setTypeSpecifier("INT");
+		$$ = (new ASTInternalNode(kind, @$.first_line, @$.last_line))->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line));
+		$$->setTypeSpecifier(TYPE_INT);
 		writeLog("factor	: variable DECOP   ");
 	}
 ;
 
 argument_list : arguments {
-		string rule = "argument_list : arguments";
-		$$ = new ASTInternalNode(rule, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::ARGUMENT_LIST;
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
 		$$->addChild($1);
 		writeLog("argument_list : arguments  ");
 	}
 	| {
-		string rule = "argument_list : ";
-		$$ = new ASTInternalNode(rule, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::ARGUMENT_LIST_EMPTY;
+		$$ = new ASTInternalNode(kind, @$.first_line, @$.last_line);
 		writeLog("argument_list :");
 	}
 	;
 
 arguments : arguments COMMA logic_expression {
-		string rule = "arguments : arguments COMMA logic_expression";
+		NodeKind kind = NodeKind::ARGUMENTS_APPEND;
 		VariableInfo *variableInfo = new VariableInfo("NN", $3->getTypeSpecifier());
 		variableList->addVariable(variableInfo);
-		$$ = new ASTVariableNode(rule, variableInfo, @$.first_line, @$.last_line);
+		$$ = new ASTVariableNode(kind, variableInfo, @$.first_line, @$.last_line);
 		$$->addChild($1)->addChild(new ASTLeafNode($2, @2.first_line))->addChild($3);
 		writeLog("arguments : arguments COMMA logic_expression ");
 	}
 	| logic_expression {
-		string rule = "arguments : logic_expression";
+		NodeKind kind = NodeKind::ARGUMENTS_FIRST;
 		VariableInfo *variableInfo = new VariableInfo("NN", $1->getTypeSpecifier());
 		variableList->addVariable(variableInfo);
-		$$ = new ASTVariableNode(rule, variableInfo, @$.first_line, @$.last_line);
+		$$ = new ASTVariableNode(kind, variableInfo, @$.first_line, @$.last_line);
 		$$->addChild($1);
 		$$->setTypeSpecifier($1->getTypeSpecifier());
 		writeLog("arguments : logic_expression");
 	}
 	| error {
-		string rule = "arguments : error";
-		$$ = new ASTVariableNode(rule, nullptr, @$.first_line, @$.last_line);
+		NodeKind kind = NodeKind::ARGUMENTS_ERROR;
+		$$ = new ASTVariableNode(kind, nullptr, @$.first_line, @$.last_line);
 		$$->setError();
 		yyclearin;
 	}
@@ -1045,38 +1091,170 @@ void writeLog(string msg){
 	logFile << msg << endl;
 }
 
-int main(int argc, char const *argv[]){
-    if (argc != 2){
-        cout<< "Usage: ./a.out <input_file>" << endl;
-        exit(1);
-    }
-	yyin = fopen(argv[1] ,"r") ; 
-	if(yyin == NULL){
-		cout<<"Cannot Open Input File." << endl;
-		exit(1);
+string outputPath(string outputDir, string fileName){
+	return outputDir.empty() ? fileName : outputDir + "/" + fileName;
+}
+
+// Compiles one translation unit, writing its output files into outputDir (the
+// current directory if empty). Returns the number of lines compiled, or -1 if
+// the input cannot be opened.
+int compileFile(string inputPath, string outputDir, int lexThreads, bool pipeline, bool bounded, bool fastCalls){
+	boundedMemory = bounded;
+	// "-" reads stdin; it and --bounded-memory both generate code unit by unit
+	streamCode = inputPath == "-" || boundedMemory;
+	FILE *inputFile = inputPath == "-" ? stdin : fopen(inputPath.c_str() ,"r") ; 
+	if(inputFile == NULL){
+		return -1;
 	}
 
 	ast = new AST();
+	ast->setFastCalls(fastCalls);
+	ast->setInlining(!bounded);
 	symbolTable = new SymbolTable(11);
 	parameterList = new VariableList();
 	variableList = new VariableList();
-
-	parseTreeFile.open("parsetree.txt");
-	errorFile.open("error.txt");
-	logFile.open("log.txt");
-
-	yyparse();
-
-	ast->printTree(parseTreeFile);
+	currentFunctionInfo = nullptr;
+	funcStackOffset = 0;
+	totalLines = 0;
+	totalErrors = 0;
+
+	parseTreeFile.open(outputPath(outputDir, "parsetree.txt"));
+	errorFile.open(outputPath(outputDir, "error.txt"));
+	logFile.open(outputPath(outputDir, "log.txt"));
+
+	beginScan(inputFile, lexThreads, pipeline);
+	if(streamCode){
+		ast->beginIntermediateCode(outputPath(outputDir, "code.asm"));
+		yypstate *parserState = yypstate_new();
+		YYSTYPE tokenValue;
+		YYLTYPE tokenLocation = {1, 1, 1, 1};
+		int status;
+		do {
+			yytoken_kind_t tokenKind = yylex(&tokenValue, &tokenLocation);
+			status = yypush_parse(parserState, tokenKind, &tokenValue, &tokenLocation);
+		} while(status == YYPUSH_MORE);
+		yypstate_delete(parserState);
+	} else {
+		yyparse();
+	}
+	endScan();
+
+	if(!boundedMemory){
+		ast->printTree(parseTreeFile);
+	}
 	logFile << "Total Lines: " << totalLines << endl;
 	logFile << "Total Errors: " << totalErrors << endl;
-	ast->generateIntermediateCode("code.asm", symbolTable);
-	optiemizeIntermediateCode("code.asm", "optimized_code.asm");
+	if(streamCode){
+		ast->endIntermediateCode();
+	} else {
+		ast->generateIntermediateCode(outputPath(outputDir, "code.asm"), symbolTable);
+	}
+	optiemizeIntermediateCode(outputPath(outputDir, "code.asm"), outputPath(outputDir, "optimized_code.asm"));
 
-	fclose(yyin);
+	if(inputFile != stdin){
+		fclose(inputFile);
+	}
 	logFile.close();
 	errorFile.close();
 	parseTreeFile.close();
 
+	delete ast;
+	delete symbolTable;
+	delete parameterList;
+	delete variableList;
+	return totalLines;
+}
+
+// Compiles every input on a pool of jobs threads. Each input gets its own
+// directory under outputDir, named after the file.
+int compileBatch(vector<string> inputPaths, string outputDir, int jobs, int lexThreads, bool pipeline, bool bounded, bool fastCalls){
+	vector<string> outputDirs;
+	map<string, int> stemCount;
+	for(string inputPath : inputPaths){
+		string stem = filesystem::path(inputPath).stem().string();
+		int count = ++stemCount[stem];
+		string dir = outputPath(outputDir, count == 1 ? stem : stem + "_" + to_string(count));
+		filesystem::create_directories(dir);
+		outputDirs.push_back(dir);
+	}
+
+	atomic<size_t> nextInput(0);
+	atomic<long long> compiledLines(0);
+	atomic<int> failedFiles(0);
+	auto startTime = chrono::steady_clock::now();
+	vector<thread> workers;
+	for(int i = 0; i < jobs; i++){
+		workers.push_back(thread([&](){
+			size_t index;
+			while((index = nextInput++) < inputPaths.size()){
+				int lines = compileFile(inputPaths[index], outputDirs[index], lexThreads, pipeline, bounded, fastCalls);
+				if(lines < 0){
+					cerr << "Cannot Open Input File: " << inputPaths[index] << endl;
+					failedFiles++;
+				} else {
+					compiledLines += lines;
+				}
+			}
+		}));
+	}
+	for(thread &worker : workers){
+		worker.join();
+	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+	int compiledFiles = inputPaths.size() - failedFiles;
+	cout << "Compiled " << compiledFiles << " of " << inputPaths.size() << " files (" << compiledLines << " lines) in " << seconds << " s on " << jobs << " threads: ";
+	cout << compiledFiles / seconds << " files/s, " << compiledLines / seconds << " lines/s" << endl;
+	return failedFiles == 0 ? 0 : 1;
+}
+
+int main(int argc, char const *argv[]){
+	int lexThreads = 1;
+	bool pipeline = false;
+	bool bounded = false;
+	bool fastCalls = false;
+	int jobs = 0;
+	string outputDir;
+	vector<string> inputPaths;
+	int argIndex = 1;
+	while (argIndex < argc){
+		string option = argv[argIndex];
+		if (option == "--lex-threads" && argIndex + 1 < argc){
+			lexThreads = atoi(argv[argIndex + 1]);
+			argIndex += 2;
+		} else if (option == "--pipeline"){
+			pipeline = true;
+			argIndex++;
+		} else if (option == "--bounded-memory"){
+			bounded = true;
+			argIndex++;
+		} else if (option == "--fast-calls"){
+			fastCalls = true;
+			argIndex++;
+		} else if (option == "-j" && argIndex + 1 < argc){
+			jobs = atoi(argv[argIndex + 1]);
+			argIndex += 2;
+		} else if (option == "-o" && argIndex + 1 < argc){
+			outputDir = argv[argIndex + 1];
+			argIndex += 2;
+		} else {
+			inputPaths.push_back(option);
+			argIndex++;
+		}
+	}
+    if (inputPaths.empty()){
+        cout<< "Usage: ./a.out [--lex-threads N | --pipeline] [--bounded-memory] [--fast-calls] <input_file | ->" << endl;
+        cout<< "       ./a.out [-j N] [-o output_dir] [--fast-calls] <input_file>..." << endl;
+        exit(1);
+    }
+
+	if (inputPaths.size() > 1 || jobs > 0 || !outputDir.empty()){
+		return compileBatch(inputPaths, outputDir, max(jobs, 1), lexThreads, pipeline, bounded, fastCalls);
+	}
+	if (compileFile(inputPaths[0], "", lexThreads, pipeline, bounded, fastCalls) < 0){
+		cout<<"Cannot Open Input File." << endl;
+		exit(1);
+	}
+
   	return 0;
-}
\ No newline at end of file
+}
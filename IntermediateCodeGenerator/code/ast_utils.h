@@ -1,35 +1,118 @@
 #pragma once
 
 #include <iostream>
+#include <algorithm>
 #include <fstream>
+#include <sstream>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 #include "lex_utils.h"
 
 using namespace std;
 
+// The grammar rule an internal node was reduced by. Code generation tests
+// the kind; the rule's text is only read when the parse tree is printed.
+enum class NodeKind : unsigned char
+{
+    START,
+    PROGRAM_APPEND, PROGRAM_FIRST,
+    UNIT_FUNC_DECLARATION, UNIT_FUNC_DEFINITION, UNIT_VAR_DECLARATION,
+    FUNC_DECLARATION_PARAMS, FUNC_DECLARATION,
+    FUNC_DEFINITION_PARAMS, FUNC_DEFINITION,
+    PARAMETER_LIST_APPEND_ID, PARAMETER_LIST_APPEND, PARAMETER_LIST_ID, PARAMETER_LIST_TYPE, PARAMETER_LIST_ERROR,
+    COMPOUND_STATEMENT, COMPOUND_STATEMENT_EMPTY,
+    VAR_DECLARATION,
+    TYPE_INT, TYPE_FLOAT, TYPE_VOID,
+    DECLARATION_LIST_APPEND_ID, DECLARATION_LIST_APPEND_ARRAY, DECLARATION_LIST_ID, DECLARATION_LIST_ARRAY, DECLARATION_LIST_ERROR,
+    STATEMENTS_FIRST, STATEMENTS_APPEND,
+    STATEMENT_VAR_DECLARATION, STATEMENT_EXPRESSION, STATEMENT_COMPOUND, STATEMENT_FOR, STATEMENT_IF, STATEMENT_IF_ELSE, STATEMENT_WHILE, STATEMENT_PRINTLN, STATEMENT_RETURN,
+    EXPRESSION_STATEMENT_EMPTY, EXPRESSION_STATEMENT,
+    VARIABLE_ID, VARIABLE_ARRAY,
+    EXPRESSION_LOGIC, EXPRESSION_ASSIGN, EXPRESSION_ERROR,
+    LOGIC_EXPRESSION_REL, LOGIC_EXPRESSION_LOGICOP,
+    REL_EXPRESSION_SIMPLE, REL_EXPRESSION_RELOP,
+    SIMPLE_EXPRESSION_TERM, SIMPLE_EXPRESSION_ADDOP,
+    TERM_UNARY, TERM_MULOP,
+    UNARY_EXPRESSION_ADDOP, UNARY_EXPRESSION_NOT, UNARY_EXPRESSION_FACTOR,
+    FACTOR_VARIABLE, FACTOR_CALL, FACTOR_PARENTHESIZED, FACTOR_CONST_INT, FACTOR_CONST_FLOAT, FACTOR_INCOP, FACTOR_DECOP,
+    ARGUMENT_LIST, ARGUMENT_LIST_EMPTY,
+    ARGUMENTS_APPEND, ARGUMENTS_FIRST, ARGUMENTS_ERROR
+};
+
+inline string_view getNodeRule(NodeKind kind)
+{
+    static constexpr string_view rules[] = {
+        "start : program",
+        "program : program unit", "program : unit",
+        "unit : func_declaration", "unit : func_definition", "unit : var_declaration",
+        "func_declaration : type_specifier ID LPAREN parameter_list RPAREN SEMICOLON", "func_declaration : type_specifier ID LPAREN RPAREN SEMICOLON",
+        "func_definition : type_specifier ID LPAREN parameter_list RPAREN compound_statement", "func_definition : type_specifier ID LPAREN RPAREN compound_statement",
+        "parameter_list : parameter_list COMMA type_specifier ID", "parameter_list : parameter_list COMMA type_specifier", "parameter_list : type_specifier ID", "parameter_list : type_specifier", "parameter_list : error",
+        "compound_statement : LCURL statements RCURL", "compound_statement : LCURL RCURL",
+        "var_declaration : type_specifier declaration_list SEMICOLON",
+        "type_specifier : INT", "type_specifier : FLOAT", "type_specifier : VOID",
+        "declaration_list : declaration_list COMMA ID", "declaration_list : declaration_list COMMA ID LSQUARE CONST_INT RSQUARE", "declaration_list : ID", "declaration_list : ID LSQUARE CONST_INT RSQUARE", "declaration_list : error",
+        "statements : statement", "statements : statements statement",
+        "statement : var_declaration", "statement : expression_statement", "statement : compound_statement", "statement : FOR LPAREN expression_statement expression_statement expression RPAREN statement", "statement : IF LPAREN expression RPAREN statement", "statement : IF LPAREN expression RPAREN statement ELSE statement", "statement : WHILE LPAREN expression RPAREN statement", "statement : PRINTLN LPAREN ID RPAREN SEMICOLON", "statement : RETURN expression SEMICOLON",
+        "expression_statement : SEMICOLON", "expression_statement : expression SEMICOLON",
+        "variable : ID", "variable : ID LSQUARE expression RSQUARE",
+        "expression : logic_expression", "expression : variable ASSIGNOP logic_expression", "expression : error",
+        "logic_expression : rel_expression", "logic_expression : rel_expression LOGICOP rel_expression",
+        "rel_expression : simple_expression", "rel_expression : simple_expression RELOP simple_expression",
+        "simple_expression : term", "simple_expression : simple_expression ADDOP term",
+        "term : unary_expression", "term : term MULOP unary_expression",
+        "unary_expression : ADDOP unary_expression", "unary_expression : NOT unary_expression", "unary_expression : factor",
+        "factor : variable", "factor : ID LPAREN argument_list RPAREN", "factor : LPAREN expression RPAREN", "factor : CONST_INT", "factor : CONST_FLOAT", "factor : variable INCOP", "factor : variable DECOP",
+        "argument_list : arguments", "argument_list : ",
+        "arguments : arguments COMMA logic_expression", "arguments : logic_expression", "arguments : error"};
+    return rules[(int)kind];
+}
+
 class ASTNode
 {
 public:
+    virtual ~ASTNode()
+    {
+    }
     virtual string toString()
     {
         return "";
     }
 };
 
+// The children of an internal node, a run of the array that holds the
+// children of every node
 class ASTNodeList
 {
 private:
-    ASTNode *nodePtr;
+    ASTNode **first;
+    ASTNode **last;
 
 public:
-    ASTNodeList *nextNodePtr;
-    ASTNodeList(ASTNode *nodePtr)
+    ASTNodeList(ASTNode **first, ASTNode **last)
+    {
+        this->first = first;
+        this->last = last;
+    }
+    ASTNode **begin()
+    {
+        return first;
+    }
+    ASTNode **end()
+    {
+        return last;
+    }
+    int size()
     {
-        this->nodePtr = nodePtr;
-        this->nextNodePtr = nullptr;
+        return last - first;
     }
-    ASTNode *getNodePtr()
+    ASTNode *operator[](int index)
     {
-        return nodePtr;
+        return first[index];
     }
 };
 
@@ -45,6 +128,15 @@ public:
         this->symbolInfo = symbolInfo;
         this->lineNo = lineNo;
     }
+    // Leaves own the token the lexer allocated for them, but not the symbol
+    // table entries some identifiers are resolved to
+    ~ASTLeafNode()
+    {
+        if (dynamic_cast<VariableInfo *>(symbolInfo) == nullptr)
+        {
+            delete symbolInfo;
+        }
+    }
     void setSymbolInfo(SymbolInfo *symbolInfo)
     {
         this->symbolInfo = symbolInfo;
@@ -59,61 +151,113 @@ public:
     }
     string toString()
     {
-        return symbolInfo->getType() + " : " + symbolInfo->getName() + "\t<Line: " + to_string(lineNo) + ">";
+        return string(symbolInfo->getKindName()) + " : " + symbolInfo->getName() + "\t<Line: " + to_string(lineNo) + ">";
     }
 };
 
+// Only what the parser decides lives in the node: the rule it was reduced
+// by, its type, its line range and where its children are. The labels and
+// flags code generation attaches to nodes are kept by the AST while it walks
+// them.
 class ASTInternalNode : public ASTNode
 {
 protected:
-    string rule;
-    ASTNodeList *children;
-    ASTNodeList *lastChild;
+    // The children of every internal node. The parser adds a node's children
+    // right after creating it, so they form one contiguous run.
+    inline static vector<ASTNode *> childArena;
+    // Entries of childArena owned by a live node. The array is emptied when
+    // none are left, as after each unit under --bounded-memory.
+    inline static size_t liveChildCount = 0;
+    unsigned int firstChild = 0;
+    unsigned int childCount = 0;
     int fisrtLineNo, lastLineNo;
+    const TypeDescriptor *typeSpecifier = TYPE_UNDEFINED;
+    NodeKind kind;
     bool zero = false;
     bool error = false;
-    string typeSpecifier = "UNDEFINED";
-    string nextLabel;
-    string trueLabel;
-    string falseLabel;
-    bool isCondition;
-    bool isSimpleExpression = false;
-    bool isNOTLogical = false;
 
 public:
-    ASTInternalNode(string rule, int fisrtLineNo, int lastLineNo)
+    ASTInternalNode(NodeKind kind, int fisrtLineNo, int lastLineNo)
     {
-        this->rule = rule;
+        this->kind = kind;
         this->fisrtLineNo = fisrtLineNo;
         this->lastLineNo = lastLineNo;
-        this->children = nullptr;
-        this->lastChild = nullptr;
     }
-    void setRule(string rule)
+    // Deletes the whole subtree. Symbol table entries referenced by variable
+    // and function nodes are not owned by the tree and are left alone. Nodes
+    // are detached from their children before being deleted, so the depth of
+    // the tree never reaches the call stack.
+    ~ASTInternalNode()
+    {
+        vector<ASTNode *> pending;
+        detachChildren(pending);
+        while (!pending.empty())
+        {
+            ASTNode *node = pending.back();
+            pending.pop_back();
+            ASTInternalNode *internalNode = dynamic_cast<ASTInternalNode *>(node);
+            if (internalNode != nullptr)
+            {
+                internalNode->detachChildren(pending);
+            }
+            delete node;
+        }
+    }
+    void detachChildren(vector<ASTNode *> &pending)
+    {
+        for (ASTNode *child : getChildren())
+        {
+            pending.push_back(child);
+        }
+        liveChildCount -= childCount;
+        childCount = 0;
+        if (liveChildCount == 0)
+        {
+            childArena.clear();
+        }
+    }
+    void setKind(NodeKind kind)
     {
-        this->rule = rule;
+        this->kind = kind;
     }
-    string getRule()
+    NodeKind getKind()
     {
-        return rule;
+        return kind;
     }
     ASTInternalNode *addChild(ASTNode *node)
     {
-        if (children == nullptr)
+        if (childCount == 0)
         {
-            this->children = new ASTNodeList(node);
-            this->lastChild = children;
+            firstChild = childArena.size();
         }
-        else
+        else if (firstChild + childCount != childArena.size())
         {
-            this->lastChild->nextNodePtr = new ASTNodeList(node);
-            this->lastChild = lastChild->nextNodePtr;
+            // Another node's children were added since; move this run to the
+            // end of the array and leave the old copy unused
+            unsigned int movedFirst = childArena.size();
+            for (unsigned int i = 0; i < childCount; i++)
+            {
+                childArena.push_back(childArena[firstChild + i]);
+            }
+            firstChild = movedFirst;
         }
+        childArena.push_back(node);
+        childCount++;
+        liveChildCount++;
         return this;
     }
-    ASTNodeList *getChildren()
+    // Valid until a child is next added to any node
+    ASTNodeList getChildren()
+    {
+        if (childCount == 0)
+        {
+            return ASTNodeList(nullptr, nullptr);
+        }
+        return ASTNodeList(childArena.data() + firstChild, childArena.data() + firstChild + childCount);
+    }
+    int getChildCount()
     {
-        return children;
+        return childCount;
     }
     void setZero()
     {
@@ -131,11 +275,11 @@ public:
     {
         return error;
     }
-    void setTypeSpecifier(string typeSpecifier)
+    void setTypeSpecifier(const TypeDescriptor *typeSpecifier)
     {
         this->typeSpecifier = typeSpecifier;
     }
-    string getTypeSpecifier()
+    const TypeDescriptor *getTypeSpecifier()
     {
         return typeSpecifier;
     }
@@ -147,61 +291,13 @@ public:
     {
         return lastLineNo;
     }
-    void setNextLabel(string label)
-    {
-        nextLabel = label;
-    }
-    string getNextLabel()
-    {
-        return nextLabel;
-    }
-    void setTrueLabel(string label)
-    {
-        trueLabel = label;
-    }
-    string getTrueLabel()
-    {
-        return trueLabel;
-    }
-    void setFalseLabel(string label)
-    {
-        falseLabel = label;
-    }
-    string getFalseLabel()
-    {
-        return falseLabel;
-    }
-    void setIsCondition(bool isCondition)
-    {
-        this->isCondition = isCondition;
-    }
-    bool getIsCondition()
-    {
-        return isCondition;
-    }
-    void setIsSimpleExpression(bool isSimpleExpression)
-    {
-        this->isSimpleExpression = isSimpleExpression;
-    }
-    bool getIsSimpleExpression()
-    {
-        return isSimpleExpression;
-    }
-    bool getIsNOTLogical()
-    {
-        return isNOTLogical;
-    }
-    void setIsNOTLogical(bool isNOTLogical)
-    {
-        this->isNOTLogical = isNOTLogical;
-    }
     string toString()
     {
         if (error)
         {
-            return rule + "\t<Line: " + to_string(fisrtLineNo) + ">";
+            return string(getNodeRule(kind)) + "\t<Line: " + to_string(fisrtLineNo) + ">";
         }
-        return rule + " \t<Line: " + to_string(fisrtLineNo) + "-" + to_string(lastLineNo) + ">";
+        return string(getNodeRule(kind)) + " \t<Line: " + to_string(fisrtLineNo) + "-" + to_string(lastLineNo) + ">";
     }
 };
 
@@ -211,10 +307,10 @@ protected:
     VariableInfo *variableInfo;
     int variableOffset;
     int arraryIndex;
-    string scopeId;
+    int scopeId;
 
 public:
-    ASTVariableNode(string rule, VariableInfo *variableInfo, int fisrtLineNo, int lastLineNo, string scopeId = "") : ASTInternalNode(rule, fisrtLineNo, lastLineNo)
+    ASTVariableNode(NodeKind kind, VariableInfo *variableInfo, int fisrtLineNo, int lastLineNo, int scopeId = 0) : ASTInternalNode(kind, fisrtLineNo, lastLineNo)
     {
         this->variableInfo = variableInfo;
         this->variableOffset = 0;
@@ -241,11 +337,11 @@ public:
     {
         return variableOffset;
     }
-    void setScopeId(string scopeId)
+    void setScopeId(int scopeId)
     {
         this->scopeId = scopeId;
     }
-    string getScopeId()
+    int getScopeId()
     {
         return scopeId;
     }
@@ -256,7 +352,7 @@ class ASTFunctionNode : public ASTInternalNode
 protected:
     FunctionInfo *functionInfo;
 public:
-    ASTFunctionNode(string rule, FunctionInfo *functionInfo, int fisrtLineNo, int lastLineNo) : ASTInternalNode(rule, fisrtLineNo, lastLineNo)
+    ASTFunctionNode(NodeKind kind, FunctionInfo *functionInfo, int fisrtLineNo, int lastLineNo) : ASTInternalNode(kind, fisrtLineNo, lastLineNo)
     {
         this->functionInfo = functionInfo;
     }
@@ -274,47 +370,191 @@ public:
     }
 };
 
+// A straight run of a procedure's code: optional label, instructions, and at
+// most one jump, which can only be the last instruction
+class BasicBlock
+{
+public:
+    int firstLine, endLine;
+    string label;
+    string jumpOp;
+    bool fallsThrough;
+    int fallThroughBlock;
+    int jumpBlock;
+    int loopDepth;
+    bool cold;
+    bool reachable;
+
+    BasicBlock(int firstLine)
+    {
+        this->firstLine = firstLine;
+        this->endLine = firstLine;
+        this->fallsThrough = true;
+        this->fallThroughBlock = -1;
+        this->jumpBlock = -1;
+        this->loopDepth = 0;
+        this->cold = false;
+        this->reachable = false;
+    }
+    vector<int> getSuccessors()
+    {
+        vector<int> successors;
+        if (fallsThrough && fallThroughBlock >= 0)
+        {
+            successors.push_back(fallThroughBlock);
+        }
+        if (jumpBlock >= 0 && jumpBlock != fallThroughBlock)
+        {
+            successors.push_back(jumpBlock);
+        }
+        return successors;
+    }
+};
+
 class AST
 {
 private:
     ASTNode *root;
     bool isCodeStarted;
     int funcParamCount;
+    int funcLocalSize;
+    int funcRegisterParamCount;
+    // Registers carrying the last arguments of a call under --fast-calls
+    vector<string> argumentRegisters = {"DI", "SI", "BX"};
+    unordered_map<string, int> registerParamCounts;
+    unordered_set<string> stackCalledFunctions;
+    // How many of the argument registers each procedure takes or hands on to
+    // a tail call; it preserves every other register it uses but AX
+    unordered_map<string, int> clobberedArgumentCounts;
+    bool fastCalls;
+    // Small leaf functions whose bodies are copied into their callers, and
+    // the calls of the current function chosen for it
+    unordered_map<string, ASTFunctionNode *> inlineCandidates;
+    unordered_set<ASTInternalNode *> inlinedCalls;
+    bool inlining;
+    int inlineCalleeBudget = 60;
+    int inlineCallerBudget = 240;
+    // Offset below BP of the frame area of the body being inlined
+    int localFrameBase = 0;
+    // A variable or array a value reads, and the scope that declared it
+    struct ValueDependency
+    {
+        string name;
+        int scopeId;
+    };
+    // Values and element addresses computed again later in their basic
+    // block, mapped to the frame temporary that carries them
+    struct AvailableValue
+    {
+        ASTInternalNode *node;
+        vector<ValueDependency> dependencies;
+        string temp;
+    };
+    unordered_map<string, AvailableValue> availableValues;
+    unordered_map<ASTInternalNode *, pair<string, vector<ValueDependency>>> valueKeys;
+    unordered_map<ASTInternalNode *, string> storedValues;
+    unordered_map<ASTInternalNode *, string> reusedValues;
+    unordered_map<ASTInternalNode *, string> storedAddresses;
+    unordered_map<ASTInternalNode *, string> reusedAddresses;
+    int valueTempBase = 0;
+    int valueTempCount = 0;
+    int maxValueTempCount = 0;
+    // Labels and condition flags a parent hands to a child before generating
+    // it. They only matter while the current function is generated, so they
+    // are kept here for the nodes that have any instead of in every node.
+    struct NodeLabels
+    {
+        string nextLabel;
+        string trueLabel;
+        string falseLabel;
+        bool isCondition = false;
+        bool isSimpleExpression = false;
+        bool isNOTLogical = false;
+    };
+    unordered_map<ASTInternalNode *, NodeLabels> nodeLabels;
     bool printLibraries;
     int labelCount = 1;
     string returnLabel;
+    string funcName;
+    // Start of the current function's body, the target of self tail calls
+    string funcBodyLabel;
     bool isReturnCalled;
     ofstream asmFile;
-    int getDataSize(string typeSpecifier)
+    // Code of the current procedure, held back until its labels are resolved
+    ostringstream pendingCode;
+    bool isPushAXPending = false;
+    unordered_set<string> pendingLabels;
+    unordered_map<string, int> labelRefs;
+    int getDataSize(const TypeDescriptor *typeSpecifier)
     {
-        if (typeSpecifier == "INT")
-        {
-            return 2;
-        }
-        else if (typeSpecifier == "FLOAT")
-        {
-            return 4;
-        }
-        else if (typeSpecifier == "DOUBLE")
-        {
-            return 8;
-        }
-        else if (typeSpecifier == "CHAR")
-        {
-            return 1;
-        }
-        return 0;
+        return typeSpecifier->dataSize;
+    }
+    NodeLabels *findNodeLabels(ASTInternalNode *node)
+    {
+        auto labels = nodeLabels.find(node);
+        return labels == nodeLabels.end() ? nullptr : &labels->second;
+    }
+    void setNextLabel(ASTInternalNode *node, string label)
+    {
+        nodeLabels[node].nextLabel = label;
+    }
+    string getNextLabel(ASTInternalNode *node)
+    {
+        NodeLabels *labels = findNodeLabels(node);
+        return labels == nullptr ? "" : labels->nextLabel;
+    }
+    void setTrueLabel(ASTInternalNode *node, string label)
+    {
+        nodeLabels[node].trueLabel = label;
+    }
+    string getTrueLabel(ASTInternalNode *node)
+    {
+        NodeLabels *labels = findNodeLabels(node);
+        return labels == nullptr ? "" : labels->trueLabel;
     }
-    ASTNodeList *getChild(ASTInternalNode *internalNode, int position)
+    void setFalseLabel(ASTInternalNode *node, string label)
     {
-        ASTNodeList *childPtr = internalNode->getChildren();
-        for (int i = 1; i < position; i++)
+        nodeLabels[node].falseLabel = label;
+    }
+    string getFalseLabel(ASTInternalNode *node)
+    {
+        NodeLabels *labels = findNodeLabels(node);
+        return labels == nullptr ? "" : labels->falseLabel;
+    }
+    void setIsCondition(ASTInternalNode *node, bool isCondition)
+    {
+        nodeLabels[node].isCondition = isCondition;
+    }
+    bool getIsCondition(ASTInternalNode *node)
+    {
+        NodeLabels *labels = findNodeLabels(node);
+        return labels == nullptr ? false : labels->isCondition;
+    }
+    void setIsSimpleExpression(ASTInternalNode *node, bool isSimpleExpression)
+    {
+        nodeLabels[node].isSimpleExpression = isSimpleExpression;
+    }
+    bool getIsSimpleExpression(ASTInternalNode *node)
+    {
+        NodeLabels *labels = findNodeLabels(node);
+        return labels == nullptr ? false : labels->isSimpleExpression;
+    }
+    void setIsNOTLogical(ASTInternalNode *node, bool isNOTLogical)
+    {
+        nodeLabels[node].isNOTLogical = isNOTLogical;
+    }
+    bool getIsNOTLogical(ASTInternalNode *node)
+    {
+        NodeLabels *labels = findNodeLabels(node);
+        return labels == nullptr ? false : labels->isNOTLogical;
+    }
+    ASTNode *getChild(ASTInternalNode *internalNode, int position)
+    {
+        if (position > internalNode->getChildCount())
         {
-            if (childPtr == nullptr)
-                break;
-            childPtr = childPtr->nextNodePtr;
+            return nullptr;
         }
-        return childPtr;
+        return internalNode->getChildren()[position - 1];
     }
 
     string gen_newline()
@@ -388,10 +628,11 @@ print_output ENDP\n";
 .MODEL SMALL\n\
 .Data\n\
     number DB '00000$'\n";
-        asmFile << starting_code;
+        printASM(starting_code);
     }
     void generateEndingCode()
     {
+        flushCode();
         if (printLibraries == true)
         {
             asmFile << gen_newline() << endl;
@@ -401,23 +642,29 @@ print_output ENDP\n";
     }
     void printASM(string _asm)
     {
-        asmFile << _asm;
+        if (isPushAXPending)
+        {
+            isPushAXPending = false;
+            pendingCode << "\tPUSH AX\n";
+        }
+        pendingCode << _asm;
     }
     void genGlobalVar(string _var_name, int _var_size = 1)
     {
         string var_declaration = "\t" + _var_name + " DW " + to_string(_var_size) + " DUP (0000H)\n";
-        asmFile << var_declaration;
+        printASM(var_declaration);
     }
     void genPROC(string _proc_name)
     {
         string proc_instruction = _proc_name + " PROC\n";
-        asmFile << proc_instruction;
+        printASM(proc_instruction);
     }
 
     void genENDP(string _proc_name)
     {
         string endp_instruction = _proc_name + " ENDP\n";
-        asmFile << endp_instruction;
+        printASM(endp_instruction);
+        flushCode();
     }
 
     void genMOV(string _reg1, string _reg2, int _lineno = 0)
@@ -425,43 +672,51 @@ print_output ENDP\n";
         if (_lineno == 0)
         {
             string mov_instruction = "\tMOV " + _reg1 + ", " + _reg2 + "\n";
-            asmFile << mov_instruction;
+            printASM(mov_instruction);
         }
         else
         {
             string mov_instruction = "\tMOV " + _reg1 + ", " + _reg2 + "       ; Line " + to_string(_lineno) + "\n";
-            asmFile << mov_instruction;
+            printASM(mov_instruction);
         }
     }
 
     void genSUB(string _reg1, string _reg2)
     {
         string sub_instruction = "\tSUB " + _reg1 + ", " + _reg2 + "\n";
-        asmFile << sub_instruction;
+        printASM(sub_instruction);
     }
 
     void genADD(string _reg1, string _reg2)
     {
         string add_instruction = "\tADD " + _reg1 + ", " + _reg2 + "\n";
-        asmFile << add_instruction;
+        printASM(add_instruction);
     }
 
     void genNOT(string _reg)
     {
         string not_instruction = "\tNOT " + _reg + "\n";
-        asmFile << not_instruction;
+        printASM(not_instruction);
     }
 
     void genNEG(string _reg)
     {
         string neg_instruction = "\tNEG " + _reg + "\n";
-        asmFile << neg_instruction;
+        printASM(neg_instruction);
     }
 
+    // PUSH AX is held back until the next instruction so that a RETURN can
+    // leave its value in AX instead of pushing and popping it
     void genPUSH(string _reg)
     {
+        if (_reg == "AX")
+        {
+            printASM("");
+            isPushAXPending = true;
+            return;
+        }
         string push_instruction = "\tPUSH " + _reg + "\n";
-        asmFile << push_instruction;
+        printASM(push_instruction);
     }
 
     void genPOP(string _reg, int _lineno = 0)
@@ -469,126 +724,2497 @@ print_output ENDP\n";
         if (_lineno == 0)
         {
             string pop_instruction = "\tPOP " + _reg + "\n";
-            asmFile << pop_instruction;
+            printASM(pop_instruction);
         }
         else
         {
             string pop_instruction = "\tPOP " + _reg + "       ; Line " + to_string(_lineno) + "\n";
-            asmFile << pop_instruction;
+            printASM(pop_instruction);
+        }
+    }
+
+    // Pops the value of an expression into AX. Under --fast-calls a value
+    // that was only just pushed from AX is left where it is.
+    void genPOPResult()
+    {
+        if (fastCalls && isPushAXPending)
+        {
+            isPushAXPending = false;
+        }
+        else
+        {
+            genPOP("AX");
         }
     }
 
     void genINT(string _int_no)
     {
         string int_instruction = "\tINT " + _int_no + "\n";
-        asmFile << int_instruction;
+        printASM(int_instruction);
     }
     void genCALL(string _proc_name)
     {
         string call_instruction = "\tCALL " + _proc_name + "\n";
-        asmFile << call_instruction;
+        printASM(call_instruction);
     }
 
     void genCWD()
     {
         string cwd_instruction = "\tCWD\n";
-        asmFile << cwd_instruction;
+        printASM(cwd_instruction);
     }
 
     void genMUL(string _reg)
     {
         string mul_instruction = "\tMUL " + _reg + "\n";
-        asmFile << mul_instruction;
+        printASM(mul_instruction);
     }
 
     void genDIV(string _reg)
     {
         string div_instruction = "\tDIV " + _reg + "\n";
-        asmFile << div_instruction;
+        printASM(div_instruction);
     }
 
     void genINC(string _reg)
     {
         string inc_instruction = "\tINC " + _reg + "\n";
-        asmFile << inc_instruction;
+        printASM(inc_instruction);
     }
 
     void genDEC(string _reg)
     {
         string dec_instruction = "\tDEC " + _reg + "\n";
-        asmFile << dec_instruction;
+        printASM(dec_instruction);
+    }
+
+    void genJL(string _label)
+    {
+        string jl_instruction = "\tJL " + _label + "\n";
+        printASM(jl_instruction);
+    }
+
+    void genJLE(string _label)
+    {
+        string jle_instruction = "\tJLE " + _label + "\n";
+        printASM(jle_instruction);
+    }
+
+    void genJG(string _label)
+    {
+        string jg_instruction = "\tJG " + _label + "\n";
+        printASM(jg_instruction);
+    }
+
+    void genJGE(string _label)
+    {
+        string jge_instruction = "\tJGE " + _label + "\n";
+        printASM(jge_instruction);
+    }
+
+    void genJE(string _label)
+    {
+        string je_instruction = "\tJE " + _label + "\n";
+        printASM(je_instruction);
+    }
+
+    void genJNE(string _label)
+    {
+        string jne_instruction = "\tJNE " + _label + "\n";
+        printASM(jne_instruction);
+    }
+
+    void genJMP(string _label)
+    {
+        string jmp_instruction = "\tJMP " + _label + "\n";
+        printASM(jmp_instruction);
+    }
+
+    void genCMP(string _reg1, string _reg2)
+    {
+        string cmp_instruction = "\tCMP " + _reg1 + ", " + _reg2 + "\n";
+        printASM(cmp_instruction);
+    }
+
+    void genRET(int popCount = 0)
+    {
+        if (popCount > 0)
+        {
+            string ret_instruction = "\tRET " + to_string(popCount) + "\n";
+            printASM(ret_instruction);
+        }
+        else
+        {
+            string ret_instruction = "\tRET\n";
+            printASM(ret_instruction);
+        }
+    }
+    string genLabel()
+    {
+        string label = "L" + to_string(labelCount);
+        labelCount++;
+        return label;
+    }
+    void printLabel(string label)
+    {
+        pendingLabels.insert(label);
+        printASM(label + ":\n");
+    }
+    bool isPendingLabel(string line)
+    {
+        return line.size() > 1 && line.back() == ':' && pendingLabels.count(line.substr(0, line.size() - 1)) > 0;
+    }
+    string getJumpOp(string line)
+    {
+        if (line.size() < 3 || line[0] != '\t' || line[1] != 'J')
+        {
+            return "";
+        }
+        string op = line.substr(1, line.find(' ') - 1);
+        if (op == "JMP" || op == "JL" || op == "JLE" || op == "JG" || op == "JGE" || op == "JE" || op == "JNE")
+        {
+            return op;
+        }
+        return "";
+    }
+    string getJumpTarget(string line)
+    {
+        return line.substr(line.find(' ') + 1);
+    }
+    string getInverseJumpOp(string op)
+    {
+        if (op == "JL")
+        {
+            return "JGE";
+        }
+        else if (op == "JGE")
+        {
+            return "JL";
+        }
+        else if (op == "JLE")
+        {
+            return "JG";
+        }
+        else if (op == "JG")
+        {
+            return "JLE";
+        }
+        else if (op == "JE")
+        {
+            return "JNE";
+        }
+        return "JE";
+    }
+    bool isProcedureEnd(string line)
+    {
+        return line.size() > 5 && line.compare(line.size() - 5, 5, " ENDP") == 0;
+    }
+    // True if control never falls through lines[i]: JMP, RET, or the exit call
+    bool endsControlFlow(vector<string> &lines, int i)
+    {
+        bool isReturn = lines[i] == "\tRET" || lines[i].compare(0, 5, "\tRET ") == 0;
+        bool isExit = lines[i] == "\tINT 21H" && i > 0 && lines[i - 1] == "\tMOV AH, 4CH";
+        return getJumpOp(lines[i]) == "JMP" || isReturn || isExit;
+    }
+    // True if label is one of the labels directly at lines[position]
+    bool labelsAt(vector<string> &lines, int position, string label)
+    {
+        while (position < lines.size() && isPendingLabel(lines[position]))
+        {
+            if (lines[position] == label + ":")
+            {
+                return true;
+            }
+            position++;
+        }
+        return false;
+    }
+    // Drops labels nobody jumps to and merges each run of adjacent labels into
+    // its first referenced one, retargeting the jumps
+    void removeDeadLabels(vector<string> &lines)
+    {
+        labelRefs.clear();
+        for (int i = 0; i < lines.size(); i++)
+        {
+            if (!getJumpOp(lines[i]).empty())
+            {
+                labelRefs[getJumpTarget(lines[i])]++;
+            }
+        }
+        unordered_map<string, string> labelAlias;
+        vector<bool> keepLine(lines.size(), true);
+        for (int i = 0; i < lines.size(); i++)
+        {
+            if (!isPendingLabel(lines[i]))
+            {
+                continue;
+            }
+            int runEnd = i;
+            string target;
+            while (runEnd < lines.size() && isPendingLabel(lines[runEnd]))
+            {
+                string label = lines[runEnd].substr(0, lines[runEnd].size() - 1);
+                if (target.empty() && labelRefs[label] > 0)
+                {
+                    target = label;
+                }
+                runEnd++;
+            }
+            for (int j = i; j < runEnd; j++)
+            {
+                string label = lines[j].substr(0, lines[j].size() - 1);
+                keepLine[j] = label == target;
+                if (!target.empty())
+                {
+                    labelAlias[label] = target;
+                }
+            }
+            i = runEnd - 1;
+        }
+        vector<string> keptLines;
+        for (int i = 0; i < lines.size(); i++)
+        {
+            if (!keepLine[i])
+            {
+                continue;
+            }
+            string op = getJumpOp(lines[i]);
+            if (!op.empty())
+            {
+                auto alias = labelAlias.find(getJumpTarget(lines[i]));
+                if (alias != labelAlias.end())
+                {
+                    lines[i] = "\t" + op + " " + alias->second;
+                }
+            }
+            keptLines.push_back(lines[i]);
+        }
+        lines.swap(keptLines);
+    }
+    // One round of jump threading over a procedure: jumps to a JMP go straight
+    // to its final target, a conditional jump over a JMP is inverted, and
+    // jumps to the next instruction are deleted. Every jump this removes is
+    // added to removedJumps. Returns true if anything changed.
+    bool threadJumps(vector<string> &lines, int &removedJumps)
+    {
+        bool changed = false;
+        unordered_map<string, int> labelLine;
+        for (int i = 0; i < lines.size(); i++)
+        {
+            if (isPendingLabel(lines[i]))
+            {
+                labelLine[lines[i].substr(0, lines[i].size() - 1)] = i;
+            }
+        }
+        for (int i = 0; i < lines.size(); i++)
+        {
+            string op = getJumpOp(lines[i]);
+            if (op.empty())
+            {
+                continue;
+            }
+            string target = getJumpTarget(lines[i]);
+            unordered_set<string> visited;
+            while (labelLine.count(target) > 0 && visited.insert(target).second)
+            {
+                int next = labelLine[target];
+                while (next < lines.size() && isPendingLabel(lines[next]))
+                {
+                    next++;
+                }
+                if (next == lines.size() || getJumpOp(lines[next]) != "JMP")
+                {
+                    break;
+                }
+                target = getJumpTarget(lines[next]);
+            }
+            if (target != getJumpTarget(lines[i]))
+            {
+                lines[i] = "\t" + op + " " + target;
+                changed = true;
+            }
+        }
+        vector<string> keptLines;
+        bool unreachable = false;
+        for (int i = 0; i < lines.size(); i++)
+        {
+            string op = getJumpOp(lines[i]);
+            if (isPendingLabel(lines[i]) || isProcedureEnd(lines[i]))
+            {
+                unreachable = false;
+            }
+            if (unreachable)
+            {
+                removedJumps += !op.empty();
+                changed = true;
+            }
+            else if (!op.empty() && op != "JMP" && i + 1 < lines.size() && getJumpOp(lines[i + 1]) == "JMP" && labelsAt(lines, i + 2, getJumpTarget(lines[i])))
+            {
+                keptLines.push_back("\t" + getInverseJumpOp(op) + " " + getJumpTarget(lines[i + 1]));
+                i++;
+                removedJumps++;
+                changed = true;
+            }
+            else if (!op.empty() && labelsAt(lines, i + 1, getJumpTarget(lines[i])))
+            {
+                removedJumps++;
+                changed = true;
+            }
+            else
+            {
+                keptLines.push_back(lines[i]);
+                unreachable = endsControlFlow(lines, i);
+            }
+        }
+        lines.swap(keptLines);
+        return changed;
+    }
+    int findChainHead(vector<int> &chainParent, int block)
+    {
+        while (chainParent[block] != block)
+        {
+            chainParent[block] = chainParent[chainParent[block]];
+            block = chainParent[block];
+        }
+        return block;
+    }
+    // Finds the PROC and ENDP lines of the procedure in lines, if there is one
+    bool findProcedure(vector<string> &lines, int &procLine, int &endpLine)
+    {
+        procLine = -1;
+        endpLine = -1;
+        for (int i = 0; i < lines.size(); i++)
+        {
+            if (procLine < 0 && lines[i].size() > 5 && lines[i].compare(lines[i].size() - 5, 5, " PROC") == 0)
+            {
+                procLine = i;
+            }
+            if (isProcedureEnd(lines[i]))
+            {
+                endpLine = i;
+            }
+        }
+        return procLine >= 0 && endpLine > procLine + 1;
+    }
+    // Splits the body of a procedure into basic blocks and links their
+    // successors. A JMP out of the procedure is a tail call and has no
+    // successor; returns false if a conditional jump leaves the procedure.
+    bool buildBlocks(vector<string> &lines, int procLine, int endpLine, vector<BasicBlock> &blocks)
+    {
+        unordered_map<string, int> labelBlock;
+        int line = procLine + 1;
+        while (line < endpLine)
+        {
+            BasicBlock block(line);
+            while (line < endpLine && isPendingLabel(lines[line]))
+            {
+                string label = lines[line].substr(0, lines[line].size() - 1);
+                if (block.label.empty())
+                {
+                    block.label = label;
+                }
+                labelBlock[label] = blocks.size();
+                line++;
+            }
+            while (line < endpLine && !isPendingLabel(lines[line]))
+            {
+                string op = getJumpOp(lines[line]);
+                bool endsBlock = endsControlFlow(lines, line);
+                line++;
+                if (!op.empty() || endsBlock)
+                {
+                    block.jumpOp = op;
+                    block.fallsThrough = !endsBlock;
+                    break;
+                }
+            }
+            block.endLine = line;
+            blocks.push_back(block);
+        }
+        for (int b = 0; b < blocks.size(); b++)
+        {
+            if (b + 1 < blocks.size())
+            {
+                blocks[b].fallThroughBlock = b + 1;
+            }
+            if (!blocks[b].jumpOp.empty())
+            {
+                auto target = labelBlock.find(getJumpTarget(lines[blocks[b].endLine - 1]));
+                if (target != labelBlock.end())
+                {
+                    blocks[b].jumpBlock = target->second;
+                }
+                else if (blocks[b].jumpOp != "JMP")
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+    // Reorders the basic blocks of a procedure so that the likely successor of
+    // each block follows it. Blocks are chained greedily along their heaviest
+    // edges, an edge weighing 10 per loop around it; back edges win ties, so
+    // loops are laid out with the test at the bottom. Blocks that only lead to
+    // an early return are moved out of line, unreachable blocks are dropped,
+    // and jumps are added wherever a fall-through successor was moved away.
+    void layoutBlocks(vector<string> &lines)
+    {
+        int procLine, endpLine;
+        vector<BasicBlock> blocks;
+        if (!findProcedure(lines, procLine, endpLine) || !buildBlocks(lines, procLine, endpLine, blocks))
+        {
+            return;
+        }
+        int blockCount = blocks.size();
+        int returnBlock = -1;
+        for (int b = 0; b < blockCount; b++)
+        {
+            if (blocks[b].jumpOp.empty() && !blocks[b].fallsThrough)
+            {
+                returnBlock = b;
+            }
+        }
+
+        // Depth-first search from the entry marks reachable blocks and back edges
+        vector<vector<int>> predecessors(blockCount);
+        vector<pair<int, int>> backEdges;
+        vector<int> visitState(blockCount, 0);
+        vector<pair<int, int>> searchStack;
+        searchStack.push_back(make_pair(0, 0));
+        visitState[0] = 1;
+        blocks[0].reachable = true;
+        while (!searchStack.empty())
+        {
+            int block = searchStack.back().first;
+            vector<int> successors = blocks[block].getSuccessors();
+            if (searchStack.back().second == successors.size())
+            {
+                visitState[block] = 2;
+                searchStack.pop_back();
+                continue;
+            }
+            int successor = successors[searchStack.back().second++];
+            predecessors[successor].push_back(block);
+            if (visitState[successor] == 1)
+            {
+                backEdges.push_back(make_pair(block, successor));
+            }
+            else if (visitState[successor] == 0)
+            {
+                visitState[successor] = 1;
+                blocks[successor].reachable = true;
+                searchStack.push_back(make_pair(successor, 0));
+            }
+        }
+        // Every block of the natural loop of a back edge is one level deeper
+        vector<int> loopMark(blockCount, -1);
+        for (int l = 0; l < backEdges.size(); l++)
+        {
+            int header = backEdges[l].second;
+            vector<int> worklist;
+            loopMark[header] = l;
+            blocks[header].loopDepth++;
+            if (loopMark[backEdges[l].first] != l)
+            {
+                loopMark[backEdges[l].first] = l;
+                blocks[backEdges[l].first].loopDepth++;
+                worklist.push_back(backEdges[l].first);
+            }
+            while (!worklist.empty())
+            {
+                int block = worklist.back();
+                worklist.pop_back();
+                for (int predecessor : predecessors[block])
+                {
+                    if (loopMark[predecessor] != l)
+                    {
+                        loopMark[predecessor] = l;
+                        blocks[predecessor].loopDepth++;
+                        worklist.push_back(predecessor);
+                    }
+                }
+            }
+        }
+        for (int b = 1; b < blockCount; b++)
+        {
+            blocks[b].cold = returnBlock >= 0 && blocks[b].jumpOp == "JMP" && blocks[b].jumpBlock == returnBlock;
+        }
+
+        // Chain blocks along edges, heaviest first
+        vector<tuple<long long, int, int, int>> edges;
+        for (int b = 0; b < blockCount; b++)
+        {
+            if (!blocks[b].reachable || blocks[b].cold)
+            {
+                continue;
+            }
+            for (int successor : blocks[b].getSuccessors())
+            {
+                if (successor == 0 || blocks[successor].cold)
+                {
+                    continue;
+                }
+                long long weight = 1;
+                for (int d = min(min(blocks[b].loopDepth, blocks[successor].loopDepth), 12); d > 0; d--)
+                {
+                    weight *= 10;
+                }
+                bool isBackEdge = find(backEdges.begin(), backEdges.end(), make_pair(b, successor)) != backEdges.end();
+                edges.push_back(make_tuple(-weight, isBackEdge ? 0 : 1, b, successor));
+            }
+        }
+        sort(edges.begin(), edges.end());
+        vector<int> chainNext(blockCount, -1), chainPrev(blockCount, -1), chainParent(blockCount);
+        for (int b = 0; b < blockCount; b++)
+        {
+            chainParent[b] = b;
+        }
+        for (auto &edge : edges)
+        {
+            int from = get<2>(edge), to = get<3>(edge);
+            if (chainNext[from] < 0 && chainPrev[to] < 0 && findChainHead(chainParent, from) != findChainHead(chainParent, to))
+            {
+                chainNext[from] = to;
+                chainPrev[to] = from;
+                chainParent[findChainHead(chainParent, to)] = findChainHead(chainParent, from);
+            }
+        }
+        // The entry chain goes first, then the other chains in source order,
+        // with cold chains last
+        vector<int> chainHeads;
+        for (int b = 1; b < blockCount; b++)
+        {
+            if (blocks[b].reachable && chainPrev[b] < 0 && !blocks[b].cold)
+            {
+                chainHeads.push_back(b);
+            }
+        }
+        for (int b = 1; b < blockCount; b++)
+        {
+            if (blocks[b].reachable && chainPrev[b] < 0 && blocks[b].cold)
+            {
+                chainHeads.push_back(b);
+            }
+        }
+        vector<int> order;
+        for (int b = 0; b != -1; b = chainNext[b])
+        {
+            order.push_back(b);
+        }
+        for (int head : chainHeads)
+        {
+            for (int b = head; b != -1; b = chainNext[b])
+            {
+                order.push_back(b);
+            }
+        }
+
+        vector<string> fallThroughJumps(blockCount);
+        for (int i = 0; i < order.size(); i++)
+        {
+            BasicBlock &block = blocks[order[i]];
+            int next = i + 1 < order.size() ? order[i + 1] : -1;
+            if (block.fallsThrough && block.fallThroughBlock >= 0 && block.fallThroughBlock != next)
+            {
+                BasicBlock &fallThrough = blocks[block.fallThroughBlock];
+                if (fallThrough.label.empty())
+                {
+                    fallThrough.label = genLabel();
+                    pendingLabels.insert(fallThrough.label);
+                    lines[fallThrough.firstLine] = fallThrough.label + ":\n" + lines[fallThrough.firstLine];
+                }
+                fallThroughJumps[order[i]] = "\tJMP " + fallThrough.label;
+            }
+        }
+        vector<string> laidOut(lines.begin(), lines.begin() + procLine + 1);
+        for (int b : order)
+        {
+            for (int i = blocks[b].firstLine; i < blocks[b].endLine; i++)
+            {
+                size_t newline = lines[i].find('\n');
+                if (newline != string::npos)
+                {
+                    laidOut.push_back(lines[i].substr(0, newline));
+                    laidOut.push_back(lines[i].substr(newline + 1));
+                }
+                else
+                {
+                    laidOut.push_back(lines[i]);
+                }
+            }
+            if (!fallThroughJumps[b].empty())
+            {
+                laidOut.push_back(fallThroughJumps[b]);
+            }
+        }
+        laidOut.insert(laidOut.end(), lines.begin() + endpLine, lines.end());
+        lines.swap(laidOut);
+    }
+    // Returns the [BP-n] or [BP+n] operand of a MOV to or from a scalar stack
+    // slot, or "" if the line does not touch one
+    string getStackSlot(string line, bool &isWrite)
+    {
+        if (line.compare(0, 5, "\tMOV ") != 0)
+        {
+            return "";
+        }
+        size_t comma = line.find(", ");
+        size_t comment = line.find(';');
+        string destination = line.substr(5, comma - 5);
+        string source = line.substr(comma + 2, comment == string::npos ? string::npos : comment - comma - 2);
+        while (!source.empty() && (source.back() == ' ' || source.back() == '\t'))
+        {
+            source.pop_back();
+        }
+        for (int operand = 0; operand < 2; operand++)
+        {
+            string slot = operand == 0 ? destination : source;
+            if (slot.size() > 5 && slot.compare(0, 3, "[BP") == 0 && (slot[3] == '-' || slot[3] == '+') && isdigit(slot[4]))
+            {
+                isWrite = operand == 0;
+                return slot;
+            }
+        }
+        return "";
+    }
+    // True if reg appears as an operand of line
+    bool namesRegister(string line, string reg)
+    {
+        size_t position = line.find(reg);
+        while (position != string::npos)
+        {
+            bool startsWord = position == 0 || !isalnum(line[position - 1]);
+            bool endsWord = position + reg.size() == line.size() || !isalnum(line[position + reg.size()]);
+            if (startsWord && endsWord)
+            {
+                return true;
+            }
+            position = line.find(reg, position + 1);
+        }
+        return false;
+    }
+    // Argument registers a call to procName may change. A procedure not
+    // generated yet may take any of them under --fast-calls.
+    int getClobberedArgumentCount(string procName)
+    {
+        auto clobberedArgumentCount = clobberedArgumentCounts.find(procName);
+        if (clobberedArgumentCount != clobberedArgumentCounts.end())
+        {
+            return clobberedArgumentCount->second;
+        }
+        return fastCalls ? argumentRegisters.size() : 0;
+    }
+    // True if line reads or writes reg, including the implicit uses of CWD,
+    // MUL and DIV, and the argument registers a called procedure may change
+    bool touchesRegister(string line, string reg)
+    {
+        line = line.substr(0, line.find(';'));
+        if (line == "\tCWD" || line.compare(0, 5, "\tMUL ") == 0 || line.compare(0, 5, "\tDIV ") == 0)
+        {
+            if (reg == "DX")
+            {
+                return true;
+            }
+        }
+        if (line.compare(0, 6, "\tCALL ") == 0)
+        {
+            string procName = line.substr(6);
+            while (!procName.empty() && (procName.back() == ' ' || procName.back() == '\t'))
+            {
+                procName.pop_back();
+            }
+            if (procName == "print_output" || procName == "new_line")
+            {
+                return false;
+            }
+            auto clobberedEnd = argumentRegisters.begin() + getClobberedArgumentCount(procName);
+            return find(argumentRegisters.begin(), clobberedEnd, reg) != clobberedEnd;
+        }
+        if (line.compare(0, 5, "\tINT ") == 0)
+        {
+            return true;
+        }
+        return namesRegister(line, reg);
+    }
+    // Keeps scalar locals and parameters of a procedure in registers. Stack
+    // slots get live intervals from a liveness analysis over the basic blocks,
+    // and a linear scan hands out whichever of DI, SI, BX, CX and DX the
+    // generated code leaves untouched over the whole interval. Other
+    // procedures save what they use, so a value may stay in a register
+    // across a call unless the callee takes that register as an argument.
+    // Slots live on entry are loaded once after the prologue. Liveness sets
+    // are bit-packed, one bit per slot, and the lines touching each register
+    // are kept as a sorted list that each candidate interval searches.
+    void allocateRegisters(vector<string> &lines)
+    {
+        int procLine, endpLine;
+        vector<BasicBlock> blocks;
+        if (!findProcedure(lines, procLine, endpLine) || !buildBlocks(lines, procLine, endpLine, blocks))
+        {
+            return;
+        }
+        unordered_map<string, int> slotIndex;
+        vector<string> slotNames;
+        vector<int> lineSlot(lines.size(), -1);
+        vector<bool> lineWritesSlot(lines.size(), false);
+        for (int i = procLine + 1; i < endpLine; i++)
+        {
+            bool isWrite = false;
+            string slot = getStackSlot(lines[i], isWrite);
+            if (slot.empty())
+            {
+                continue;
+            }
+            if (slotIndex.count(slot) == 0)
+            {
+                slotIndex[slot] = slotNames.size();
+                slotNames.push_back(slot);
+            }
+            lineSlot[i] = slotIndex[slot];
+            lineWritesSlot[i] = isWrite;
+        }
+        int slotCount = slotNames.size();
+        int blockCount = blocks.size();
+        if (slotCount == 0)
+        {
+            return;
+        }
+
+        int wordCount = (slotCount + 63) / 64;
+        auto hasSlot = [](vector<unsigned long long> &slots, int slot)
+        {
+            return (slots[slot >> 6] >> (slot & 63)) & 1;
+        };
+        vector<vector<unsigned long long>> slotUse(blockCount, vector<unsigned long long>(wordCount, 0));
+        vector<vector<unsigned long long>> slotDef(blockCount, vector<unsigned long long>(wordCount, 0));
+        vector<vector<unsigned long long>> liveIn(blockCount, vector<unsigned long long>(wordCount, 0));
+        vector<vector<unsigned long long>> liveOut(blockCount, vector<unsigned long long>(wordCount, 0));
+        for (int b = 0; b < blockCount; b++)
+        {
+            for (int i = blocks[b].firstLine; i < blocks[b].endLine; i++)
+            {
+                int slot = lineSlot[i];
+                if (slot >= 0 && lineWritesSlot[i])
+                {
+                    slotDef[b][slot >> 6] |= 1ULL << (slot & 63);
+                }
+                else if (slot >= 0 && !hasSlot(slotDef[b], slot))
+                {
+                    slotUse[b][slot >> 6] |= 1ULL << (slot & 63);
+                }
+            }
+        }
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (int b = blockCount - 1; b >= 0; b--)
+            {
+                for (int successor : blocks[b].getSuccessors())
+                {
+                    for (int word = 0; word < wordCount; word++)
+                    {
+                        liveOut[b][word] |= liveIn[successor][word];
+                    }
+                }
+                for (int word = 0; word < wordCount; word++)
+                {
+                    unsigned long long live = slotUse[b][word] | (liveOut[b][word] & ~slotDef[b][word]);
+                    if (live != liveIn[b][word])
+                    {
+                        liveIn[b][word] = live;
+                        changed = true;
+                    }
+                }
+            }
+        }
+        // A slot's interval spans every line where it is referenced or live
+        vector<int> intervalStart(slotCount, lines.size()), intervalEnd(slotCount, -1);
+        auto extendInterval = [&](int slot, int line)
+        {
+            intervalStart[slot] = min(intervalStart[slot], line);
+            intervalEnd[slot] = max(intervalEnd[slot], line);
+        };
+        auto extendLiveSlots = [&](vector<unsigned long long> &slots, int line)
+        {
+            for (int word = 0; word < wordCount; word++)
+            {
+                for (unsigned long long bits = slots[word]; bits != 0; bits &= bits - 1)
+                {
+                    int bit = 0;
+                    while (((bits >> bit) & 1) == 0)
+                    {
+                        bit++;
+                    }
+                    extendInterval(word * 64 + bit, line);
+                }
+            }
+        };
+        for (int b = 0; b < blockCount; b++)
+        {
+            extendLiveSlots(liveIn[b], blocks[b].firstLine);
+            extendLiveSlots(liveOut[b], blocks[b].endLine - 1);
+            for (int i = blocks[b].firstLine; i < blocks[b].endLine; i++)
+            {
+                if (lineSlot[i] >= 0)
+                {
+                    extendInterval(lineSlot[i], i);
+                }
+            }
+        }
+
+        vector<string> registers = {"DI", "SI", "BX", "CX", "DX"};
+        vector<vector<int>> touchLines(registers.size());
+        for (int i = procLine + 1; i < endpLine; i++)
+        {
+            for (int r = 0; r < registers.size(); r++)
+            {
+                if (touchesRegister(lines[i], registers[r]))
+                {
+                    touchLines[r].push_back(i);
+                }
+            }
+        }
+        // A slot live on entry costs a load, which a single use cannot repay
+        vector<int> slotReferences(slotCount, 0);
+        for (int i = procLine + 1; i < endpLine; i++)
+        {
+            if (lineSlot[i] >= 0)
+            {
+                slotReferences[lineSlot[i]]++;
+            }
+        }
+        // A tail call hands its arguments over in our parameter slots, so
+        // slots touched on the way out of the procedure stay in memory
+        vector<bool> pinned(slotCount, false);
+        for (int b = 0; b < blockCount; b++)
+        {
+            for (int i = blocks[b].firstLine; i < blocks[b].endLine && blocks[b].jumpOp == "JMP" && blocks[b].jumpBlock < 0; i++)
+            {
+                if (lineSlot[i] >= 0)
+                {
+                    pinned[lineSlot[i]] = true;
+                }
+            }
+        }
+        vector<int> slotOrder;
+        for (int slot = 0; slot < slotCount; slot++)
+        {
+            if (!pinned[slot] && (!hasSlot(liveIn[0], slot) || slotReferences[slot] > 1))
+            {
+                slotOrder.push_back(slot);
+            }
+        }
+        sort(slotOrder.begin(), slotOrder.end(), [&](int a, int b)
+             { return intervalStart[a] < intervalStart[b]; });
+        vector<int> slotRegister(slotCount, -1);
+        vector<int> active;
+        for (int slot : slotOrder)
+        {
+            int start = intervalStart[slot], end = intervalEnd[slot];
+            vector<bool> registerBusy(registers.size(), false);
+            for (int i = 0; i < active.size(); i++)
+            {
+                if (intervalEnd[active[i]] < start)
+                {
+                    active.erase(active.begin() + i);
+                    i--;
+                }
+                else
+                {
+                    registerBusy[slotRegister[active[i]]] = true;
+                }
+            }
+            // A slot that starts out as a copy of a register may take over
+            // that register, which turns the copy into a no-op
+            int copiedRegister = -1;
+            if (lineSlot[start] == slot && lineWritesSlot[start])
+            {
+                string line = lines[start].substr(0, lines[start].find(';'));
+                string source = line.substr(line.find(", ") + 2);
+                while (!source.empty() && source.back() == ' ')
+                {
+                    source.pop_back();
+                }
+                copiedRegister = find(registers.begin(), registers.end(), source) - registers.begin();
+            }
+            auto isFreeOver = [&](int r)
+            {
+                int from = r == copiedRegister ? start + 1 : start;
+                auto touch = lower_bound(touchLines[r].begin(), touchLines[r].end(), from);
+                return touch == touchLines[r].end() || *touch > end;
+            };
+            vector<int> candidates;
+            if (copiedRegister >= 0 && copiedRegister < registers.size())
+            {
+                candidates.push_back(copiedRegister);
+            }
+            for (int r = 0; r < registers.size(); r++)
+            {
+                candidates.push_back(r);
+            }
+            for (int r : candidates)
+            {
+                if (slotRegister[slot] < 0 && !registerBusy[r] && isFreeOver(r))
+                {
+                    slotRegister[slot] = r;
+                    active.push_back(slot);
+                }
+            }
+            if (slotRegister[slot] >= 0)
+            {
+                continue;
+            }
+            // Spill whichever interval ends last, if it is not this one and
+            // is not referenced more often than this one
+            int victim = -1;
+            for (int i = 0; i < active.size(); i++)
+            {
+                if (intervalEnd[active[i]] > end && slotReferences[active[i]] <= slotReferences[slot] && isFreeOver(slotRegister[active[i]]) && (victim < 0 || intervalEnd[active[i]] > intervalEnd[active[victim]]))
+                {
+                    victim = i;
+                }
+            }
+            if (victim >= 0)
+            {
+                slotRegister[slot] = slotRegister[active[victim]];
+                slotRegister[active[victim]] = -1;
+                active[victim] = slot;
+            }
+        }
+
+        int prologueEnd = procLine;
+        for (int i = procLine + 1; i < endpLine; i++)
+        {
+            if (lines[i] == "\tMOV BP, SP" || lines[i].compare(0, 9, "\tSUB SP, ") == 0)
+            {
+                prologueEnd = i;
+            }
+            if (lines[i].compare(0, 9, "\tSUB SP, ") == 0)
+            {
+                break;
+            }
+        }
+        vector<bool> selfCopy(lines.size(), false);
+        for (int i = procLine + 1; i < endpLine; i++)
+        {
+            if (lineSlot[i] >= 0 && slotRegister[lineSlot[i]] >= 0)
+            {
+                string reg = registers[slotRegister[lineSlot[i]]];
+                lines[i].replace(lines[i].find(slotNames[lineSlot[i]]), slotNames[lineSlot[i]].size(), reg);
+                selfCopy[i] = lines[i].compare(0, 5 + 2 * reg.size() + 2, "\tMOV " + reg + ", " + reg) == 0;
+            }
+        }
+        vector<string> entryLoads;
+        for (int slot = 0; slot < slotCount; slot++)
+        {
+            if (slotRegister[slot] >= 0 && hasSlot(liveIn[0], slot))
+            {
+                entryLoads.push_back("\tMOV " + registers[slotRegister[slot]] + ", " + slotNames[slot]);
+            }
+        }
+        vector<string> allocatedLines;
+        for (int i = 0; i < lines.size(); i++)
+        {
+            if (!selfCopy[i])
+            {
+                allocatedLines.push_back(lines[i]);
+            }
+            if (i == prologueEnd)
+            {
+                allocatedLines.insert(allocatedLines.end(), entryLoads.begin(), entryLoads.end());
+            }
+        }
+        lines.swap(allocatedLines);
+    }
+    // Drops the frame of a procedure that no longer addresses anything through
+    // BP, which is the case once every stack slot has been given a register
+    void elideFrame(vector<string> &lines)
+    {
+        int procLine, endpLine;
+        if (!findProcedure(lines, procLine, endpLine))
+        {
+            return;
+        }
+        vector<string> keptLines;
+        for (int i = 0; i < lines.size(); i++)
+        {
+            string instruction = lines[i].substr(0, lines[i].find(';'));
+            bool isFrameLine = instruction == "\tPUSH BP" || instruction == "\tMOV BP, SP" || instruction == "\tPOP BP" || instruction.compare(0, 9, "\tSUB SP, ") == 0 || instruction.compare(0, 9, "\tADD SP, ") == 0;
+            if (i > procLine && i < endpLine && !isFrameLine && (namesRegister(instruction, "BP") || namesRegister(instruction, "SP")))
+            {
+                return;
+            }
+            if (!(i > procLine && i < endpLine && isFrameLine))
+            {
+                keptLines.push_back(lines[i]);
+            }
+        }
+        lines.swap(keptLines);
+    }
+    // Packs the scalar stack slots a procedure still uses after register
+    // allocation next to each other and shrinks its frame to fit them. Local
+    // arrays are addressed through SI with their offsets folded into the index
+    // arithmetic, so a procedure that has one keeps its frame as it is.
+    void shrinkFrame(vector<string> &lines)
+    {
+        int procLine, endpLine;
+        if (!findProcedure(lines, procLine, endpLine))
+        {
+            return;
+        }
+        int frameLine = -1;
+        for (int i = procLine + 1; i < endpLine && frameLine < 0; i++)
+        {
+            if (lines[i].compare(0, 9, "\tSUB SP, ") == 0)
+            {
+                frameLine = i;
+            }
+        }
+        if (frameLine < 0)
+        {
+            return;
+        }
+        int frameSize = stoi(lines[frameLine].substr(9));
+        vector<bool> slotUsed(frameSize / 2 + 1, false);
+        for (int i = procLine + 1; i < endpLine; i++)
+        {
+            string instruction = lines[i].substr(0, lines[i].find(';'));
+            for (size_t position = instruction.find("[BP"); position != string::npos; position = instruction.find("[BP", position + 1))
+            {
+                size_t close = instruction.find(']', position);
+                string offset = instruction.substr(position + 3, close - position - 3);
+                bool isLiteral = offset.size() > 1 && (offset[0] == '+' || offset[0] == '-') && all_of(offset.begin() + 1, offset.end(), ::isdigit);
+                if (!isLiteral)
+                {
+                    return;
+                }
+                int bytes = stoi(offset.substr(1));
+                if (offset[0] == '-' && (bytes % 2 != 0 || bytes > frameSize))
+                {
+                    return;
+                }
+                if (offset[0] == '-')
+                {
+                    slotUsed[bytes / 2] = true;
+                }
+            }
+        }
+        vector<int> packedOffset(slotUsed.size(), 0);
+        int newFrameSize = 0;
+        for (int slot = 1; slot < slotUsed.size(); slot++)
+        {
+            if (slotUsed[slot])
+            {
+                newFrameSize += 2;
+                packedOffset[slot] = newFrameSize;
+            }
+        }
+        if (newFrameSize == frameSize)
+        {
+            return;
+        }
+        vector<string> keptLines;
+        for (int i = 0; i < lines.size(); i++)
+        {
+            if (i > procLine && i < endpLine)
+            {
+                if (i == frameLine)
+                {
+                    lines[i] = "\tSUB SP, " + to_string(newFrameSize);
+                }
+                else if (lines[i] == "\tADD SP, " + to_string(frameSize) && i + 1 < endpLine && lines[i + 1] == "\tPOP BP")
+                {
+                    if (newFrameSize == 0)
+                    {
+                        continue;
+                    }
+                    lines[i] = "\tADD SP, " + to_string(newFrameSize);
+                }
+                for (size_t position = lines[i].find("[BP-"); position != string::npos; position = lines[i].find("[BP-", position + 1))
+                {
+                    size_t close = lines[i].find(']', position);
+                    int bytes = stoi(lines[i].substr(position + 4, close - position - 4));
+                    lines[i].replace(position + 4, close - position - 4, to_string(packedOffset[bytes / 2]));
+                }
+            }
+            keptLines.push_back(lines[i]);
+        }
+        lines.swap(keptLines);
+    }
+    // Saves the registers a procedure other than main uses, apart from AX and
+    // the argument registers it takes or hands on to a tail call, right after
+    // its prologue. They are restored on every way out: before the epilogue
+    // that ends in RET, and before the frame is dropped for a tail call.
+    void saveRegisters(vector<string> &lines)
+    {
+        int procLine, endpLine;
+        if (!findProcedure(lines, procLine, endpLine))
+        {
+            return;
+        }
+        string procName = lines[procLine].substr(0, lines[procLine].size() - 5);
+        if (procName == "main")
+        {
+            return;
+        }
+        auto clobberedEnd = argumentRegisters.begin() + getClobberedArgumentCount(procName);
+        vector<string> savedRegisters;
+        for (string reg : {"BX", "CX", "DX", "SI", "DI"})
+        {
+            if (find(argumentRegisters.begin(), clobberedEnd, reg) != clobberedEnd)
+            {
+                continue;
+            }
+            for (int i = procLine + 1; i < endpLine; i++)
+            {
+                if (touchesRegister(lines[i], reg))
+                {
+                    savedRegisters.push_back(reg);
+                    break;
+                }
+            }
+        }
+        if (savedRegisters.empty())
+        {
+            return;
+        }
+        auto isFrameLine = [&](int i)
+        {
+            return lines[i] == "\tPUSH BP" || lines[i] == "\tMOV BP, SP" || lines[i] == "\tPOP BP" || lines[i] == "\tMOV SP, BP" || lines[i].compare(0, 9, "\tSUB SP, ") == 0 || lines[i].compare(0, 9, "\tADD SP, ") == 0;
+        };
+        int prologueEnd = procLine;
+        while (prologueEnd + 1 < endpLine && isFrameLine(prologueEnd + 1))
+        {
+            prologueEnd++;
+        }
+        unordered_set<string> localLabels;
+        for (int i = procLine + 1; i < endpLine; i++)
+        {
+            if (isPendingLabel(lines[i]))
+            {
+                localLabels.insert(lines[i].substr(0, lines[i].size() - 1));
+            }
+        }
+        vector<bool> restoresBefore(lines.size(), false);
+        for (int i = prologueEnd + 1; i < endpLine; i++)
+        {
+            string destination, source;
+            string op = splitInstruction(lines[i], destination, source);
+            if (op == "RET" || (op == "JMP" && localLabels.count(destination) == 0))
+            {
+                int exit = i;
+                while (exit > prologueEnd + 1 && isFrameLine(exit - 1))
+                {
+                    exit--;
+                }
+                restoresBefore[exit] = true;
+            }
+        }
+        vector<string> savedLines;
+        for (int i = 0; i < lines.size(); i++)
+        {
+            if (restoresBefore[i])
+            {
+                for (int r = savedRegisters.size() - 1; r >= 0; r--)
+                {
+                    savedLines.push_back("\tPOP " + savedRegisters[r]);
+                }
+            }
+            savedLines.push_back(lines[i]);
+            if (i == prologueEnd)
+            {
+                for (string reg : savedRegisters)
+                {
+                    savedLines.push_back("\tPUSH " + reg);
+                }
+            }
+        }
+        lines.swap(savedLines);
+    }
+    // Splits an instruction into its opcode and operands, leaving out the
+    // comment. Labels and comment-only lines have no opcode.
+    string splitInstruction(string line, string &destination, string &source)
+    {
+        destination = "";
+        source = "";
+        if (line.empty() || line[0] != '\t')
+        {
+            return "";
+        }
+        string instruction = line.substr(1, line.find(';') == string::npos ? string::npos : line.find(';') - 1);
+        while (!instruction.empty() && (instruction.back() == ' ' || instruction.back() == '\t'))
+        {
+            instruction.pop_back();
+        }
+        size_t space = instruction.find(' ');
+        if (space != string::npos)
+        {
+            string operands = instruction.substr(space + 1);
+            size_t comma = operands.find(", ");
+            destination = operands.substr(0, comma);
+            source = comma == string::npos ? "" : operands.substr(comma + 2);
+        }
+        return instruction.substr(0, space);
+    }
+    // Replaces the instruction on line, keeping its comment
+    string replaceInstruction(string line, string instruction)
+    {
+        size_t comment = line.find(';');
+        if (comment == string::npos)
+        {
+            return "\t" + instruction;
+        }
+        while (comment > 0 && (line[comment - 1] == ' ' || line[comment - 1] == '\t'))
+        {
+            comment--;
+        }
+        return "\t" + instruction + line.substr(comment);
+    }
+    // Bit mask of the general registers named in operand; AH and AL count as
+    // AX, and so on
+    int getRegisterMask(string operand)
+    {
+        static const string registerNames[] = {"AX", "BX", "CX", "DX", "SI", "DI"};
+        int mask = 0;
+        for (int r = 0; r < 6; r++)
+        {
+            bool named = namesRegister(operand, registerNames[r]);
+            if (r < 4)
+            {
+                named = named || namesRegister(operand, registerNames[r].substr(0, 1) + "H") || namesRegister(operand, registerNames[r].substr(0, 1) + "L");
+            }
+            if (named)
+            {
+                mask |= 1 << r;
+            }
+        }
+        return mask;
+    }
+    // The mask of operand if it is a whole general register, 0 otherwise
+    int getWholeRegisterMask(string operand)
+    {
+        return operand.size() == 2 && operand[1] != 'H' && operand[1] != 'L' ? getRegisterMask(operand) : 0;
+    }
+    bool isImmediate(string operand)
+    {
+        return !operand.empty() && (isdigit(operand[0]) || operand[0] == '-' || operand[0] == '@' || operand[0] == '\'');
+    }
+    // True if operand is a variable, array element or stack slot
+    bool isMemoryOperand(string operand)
+    {
+        if (operand.find('[') != string::npos)
+        {
+            return true;
+        }
+        return !operand.empty() && isalpha(operand[0]) && getRegisterMask(operand) == 0 && operand != "BP" && operand != "SP" && operand != "DS";
+    }
+    // True if operand is memory addressed through a general register
+    bool isIndexedOperand(string operand)
+    {
+        return operand.find('[') != string::npos && getRegisterMask(operand) != 0;
+    }
+    // Which general registers an instruction reads and which it overwrites
+    // completely. Calls to other procedures and anything unrecognised read
+    // all of them.
+    void getRegisterEffects(string line, int &uses, int &defines)
+    {
+        const int allRegisters = (1 << 6) - 1;
+        string destination, source;
+        string op = splitInstruction(line, destination, source);
+        uses = 0;
+        defines = 0;
+        if (op.empty() || !getJumpOp(line).empty())
+        {
+            return;
+        }
+        if (op == "MOV" || op == "POP")
+        {
+            defines = getWholeRegisterMask(destination);
+            uses = (defines == 0 ? getRegisterMask(destination) : 0) | getRegisterMask(source);
+        }
+        else if (op == "PUSH" || op == "CMP" || op == "ADD" || op == "SUB" || op == "INC" || op == "DEC" || op == "NEG")
+        {
+            uses = getRegisterMask(destination) | getRegisterMask(source);
+        }
+        else if (op == "MUL" || op == "DIV")
+        {
+            uses = getRegisterMask("AX") | getRegisterMask(destination) | (op == "DIV" ? getRegisterMask("DX") : 0);
+            defines = getRegisterMask("AX") | getRegisterMask("DX");
+        }
+        else if (op == "CWD")
+        {
+            uses = getRegisterMask("AX");
+            defines = getRegisterMask("DX");
+        }
+        else if (op == "CALL" && (destination == "print_output" || destination == "new_line"))
+        {
+            uses = destination == "print_output" ? getRegisterMask("AX") : 0;
+        }
+        else if (op == "RET")
+        {
+            uses = getRegisterMask("AX");
+        }
+        else
+        {
+            uses = allRegisters;
+        }
+    }
+    // Records that location now holds value, forgetting memory operands
+    // addressed through it and, for stores, memory they may alias
+    void setLocationValue(unordered_map<string, int> &values, string location, int value)
+    {
+        bool isMemory = isMemoryOperand(location);
+        bool isIndexed = isIndexedOperand(location);
+        for (auto entry = values.begin(); entry != values.end();)
+        {
+            string other = entry->first;
+            bool stale;
+            if (isMemory)
+            {
+                stale = isMemoryOperand(other) && (isIndexed || isIndexedOperand(other));
+            }
+            else
+            {
+                stale = other.find('[') != string::npos && namesRegister(other, location);
+            }
+            entry = stale ? values.erase(entry) : next(entry);
+        }
+        values[location] = value;
+    }
+    // Returns the value number of an operand, numbering it if it is new
+    int getLocationValue(unordered_map<string, int> &values, string operand, int &valueCount)
+    {
+        string key = isImmediate(operand) ? "#" + operand : operand;
+        auto entry = values.find(key);
+        if (entry != values.end())
+        {
+            return entry->second;
+        }
+        values[key] = valueCount;
+        return valueCount++;
+    }
+    // Returns the constant with the given value number, or ""
+    string findConstant(unordered_map<string, int> &values, int value)
+    {
+        for (auto &entry : values)
+        {
+            if (entry.second == value && entry.first[0] == '#')
+            {
+                return entry.first.substr(1);
+            }
+        }
+        return "";
+    }
+    // Returns an operand that holds value, preferring registers, then
+    // constants, then memory; "" if nothing does
+    string findValue(unordered_map<string, int> &values, int value)
+    {
+        static const string registerNames[] = {"AX", "BX", "CX", "DX", "SI", "DI"};
+        for (string reg : registerNames)
+        {
+            auto entry = values.find(reg);
+            if (entry != values.end() && entry->second == value)
+            {
+                return reg;
+            }
+        }
+        string found = findConstant(values, value);
+        if (!found.empty())
+        {
+            return found;
+        }
+        for (auto &entry : values)
+        {
+            if (entry.second == value && isMemoryOperand(entry.first) && (found.empty() || entry.first < found))
+            {
+                found = entry.first;
+            }
+        }
+        return found;
+    }
+    // Forwards values through each basic block of a procedure. Locations are
+    // given value numbers as the block is walked, so a move of a value the
+    // destination already holds is dropped, a load of a value some register
+    // holds becomes a register copy, and a POP is matched with its PUSH and
+    // replaced by a move from wherever the value still lives.
+    bool forwardBlockValues(vector<string> &lines, int procLine, int endpLine)
+    {
+        bool changed = false;
+        vector<bool> removed(lines.size(), false);
+        unordered_map<string, int> values;
+        vector<pair<int, int>> pushedValues;
+        int valueCount = 0;
+        for (int i = procLine + 1; i < endpLine; i++)
+        {
+            string destination, source;
+            string op = splitInstruction(lines[i], destination, source);
+            string jumpOp = getJumpOp(lines[i]);
+            if (isPendingLabel(lines[i]) || jumpOp == "JMP" || op == "RET" || op == "INT")
+            {
+                values.clear();
+                pushedValues.clear();
+                continue;
+            }
+            if (op.empty())
+            {
+                continue;
+            }
+            if (!jumpOp.empty())
+            {
+                pushedValues.clear();
+                continue;
+            }
+            if (op == "PUSH" && i + 1 < endpLine && (getWholeRegisterMask(destination) != 0 || isMemoryOperand(destination)))
+            {
+                string popped, unused;
+                if (splitInstruction(lines[i + 1], popped, unused) == "POP" && getWholeRegisterMask(popped) != 0)
+                {
+                    removed[i] = true;
+                    changed = true;
+                    if (popped == destination)
+                    {
+                        removed[i + 1] = true;
+                        i++;
+                    }
+                    else
+                    {
+                        lines[i + 1] = replaceInstruction(lines[i + 1], "MOV " + popped + ", " + destination);
+                    }
+                    continue;
+                }
+            }
+            string parent = destination;
+            if (destination.size() == 2 && getRegisterMask(destination) != 0 && getWholeRegisterMask(destination) == 0)
+            {
+                parent = string(1, destination[0]) + "X";
+            }
+            if (op == "MOV" && parent == destination)
+            {
+                int value = getLocationValue(values, source, valueCount);
+                auto held = values.find(destination);
+                if (held != values.end() && held->second == value)
+                {
+                    removed[i] = true;
+                    changed = true;
+                    continue;
+                }
+                string reg = isMemoryOperand(source) ? findValue(values, value) : "";
+                string constant = getWholeRegisterMask(destination) != 0 && getWholeRegisterMask(source) != 0 ? findConstant(values, value) : "";
+                if (getWholeRegisterMask(reg) != 0 && reg != destination)
+                {
+                    lines[i] = replaceInstruction(lines[i], "MOV " + destination + ", " + reg);
+                    changed = true;
+                }
+                else if (!constant.empty())
+                {
+                    lines[i] = replaceInstruction(lines[i], "MOV " + destination + ", " + constant);
+                    changed = true;
+                }
+                setLocationValue(values, destination, value);
+            }
+            else if (op == "PUSH")
+            {
+                pushedValues.push_back({getLocationValue(values, destination, valueCount), i});
+            }
+            else if (op == "POP" && !pushedValues.empty() && getWholeRegisterMask(destination) != 0)
+            {
+                int value = pushedValues.back().first;
+                int pushLine = pushedValues.back().second;
+                pushedValues.pop_back();
+                string holder = findValue(values, value);
+                auto held = values.find(destination);
+                if (held != values.end() && held->second == value)
+                {
+                    removed[i] = true;
+                    removed[pushLine] = true;
+                    changed = true;
+                    continue;
+                }
+                if (!holder.empty())
+                {
+                    lines[i] = replaceInstruction(lines[i], "MOV " + destination + ", " + holder);
+                    removed[pushLine] = true;
+                    changed = true;
+                }
+                setLocationValue(values, destination, value);
+            }
+            else if (op == "MUL" || op == "DIV" || op == "CWD")
+            {
+                if (op != "CWD")
+                {
+                    setLocationValue(values, "AX", valueCount++);
+                }
+                setLocationValue(values, "DX", valueCount++);
+            }
+            else if (op == "CALL" && (destination == "print_output" || destination == "new_line"))
+            {
+                continue;
+            }
+            else if (op == "CALL")
+            {
+                // Other procedures may change any register or global, but
+                // not the stack slots of this one
+                for (auto entry = values.begin(); entry != values.end();)
+                {
+                    bool kept = entry->first[0] == '#' || (entry->first.compare(0, 3, "[BP") == 0 && !isIndexedOperand(entry->first));
+                    entry = kept ? next(entry) : values.erase(entry);
+                }
+                pushedValues.clear();
+            }
+            else if (op == "MOV" || op == "POP" || op == "ADD" || op == "SUB" || op == "INC" || op == "DEC" || op == "NEG")
+            {
+                if (op == "POP" && !pushedValues.empty())
+                {
+                    pushedValues.pop_back();
+                }
+                if (parent == "SP")
+                {
+                    pushedValues.clear();
+                }
+                setLocationValue(values, parent, valueCount++);
+            }
+            else if (op != "CMP")
+            {
+                values.clear();
+                pushedValues.clear();
+            }
+        }
+        removeLines(lines, removed);
+        return changed;
+    }
+    // Drops moves into registers that are dead, together with PUSH and POP
+    // pairs whose value is never read, using a liveness analysis of the
+    // general registers over the basic blocks. Stores to scalar variables that
+    // are overwritten later in the same block before being read go as well.
+    bool removeDeadMoves(vector<string> &lines, int procLine, int endpLine)
+    {
+        const int allRegisters = (1 << 6) - 1;
+        vector<BasicBlock> blocks;
+        if (!buildBlocks(lines, procLine, endpLine, blocks))
+        {
+            return false;
+        }
+        int blockCount = blocks.size();
+        vector<int> lineUses(lines.size(), 0), lineDefines(lines.size(), 0);
+        vector<int> blockUses(blockCount, 0), blockDefines(blockCount, 0);
+        vector<int> liveIn(blockCount, 0), liveOut(blockCount, 0);
+        for (int b = 0; b < blockCount; b++)
+        {
+            for (int i = blocks[b].endLine - 1; i >= blocks[b].firstLine; i--)
+            {
+                getRegisterEffects(lines[i], lineUses[i], lineDefines[i]);
+                blockUses[b] = (blockUses[b] & ~lineDefines[i]) | lineUses[i];
+                blockDefines[b] = (blockDefines[b] | lineDefines[i]) & ~lineUses[i];
+            }
+        }
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (int b = blockCount - 1; b >= 0; b--)
+            {
+                vector<int> successors = blocks[b].getSuccessors();
+                string lastOp = blocks[b].endLine > blocks[b].firstLine ? lines[blocks[b].endLine - 1] : "";
+                int live = successors.empty() && lastOp.compare(0, 4, "\tRET") != 0 ? allRegisters : 0;
+                for (int successor : successors)
+                {
+                    live |= liveIn[successor];
+                }
+                liveOut[b] = live;
+                live = blockUses[b] | (live & ~blockDefines[b]);
+                if (live != liveIn[b])
+                {
+                    liveIn[b] = live;
+                    changed = true;
+                }
+            }
+        }
+
+        // Each POP is matched with its PUSH while walking the block forwards
+        vector<int> matchedPush(lines.size(), -1);
+        for (int b = 0; b < blockCount; b++)
+        {
+            vector<int> pushLines;
+            for (int i = blocks[b].firstLine; i < blocks[b].endLine; i++)
+            {
+                string destination, source;
+                string op = splitInstruction(lines[i], destination, source);
+                if (op == "PUSH")
+                {
+                    pushLines.push_back(i);
+                }
+                else if (op == "POP" && !pushLines.empty())
+                {
+                    matchedPush[i] = pushLines.back();
+                    pushLines.pop_back();
+                }
+                else if (!getJumpOp(lines[i]).empty() || lineUses[i] == allRegisters || destination == "SP")
+                {
+                    pushLines.clear();
+                }
+            }
+        }
+
+        bool removedAny = false;
+        vector<bool> removed(lines.size(), false);
+        for (int b = 0; b < blockCount; b++)
+        {
+            int live = liveOut[b];
+            unordered_set<string> overwrittenStores;
+            for (int i = blocks[b].endLine - 1; i >= blocks[b].firstLine; i--)
+            {
+                if (removed[i])
+                {
+                    continue;
+                }
+                string destination, source;
+                string op = splitInstruction(lines[i], destination, source);
+                bool isDeadMove = op == "MOV" && lineDefines[i] != 0 && (live & lineDefines[i]) == 0;
+                bool isDeadPop = op == "POP" && lineDefines[i] != 0 && (live & lineDefines[i]) == 0 && matchedPush[i] >= 0;
+                bool isScalarStore = op == "MOV" && isMemoryOperand(destination) && !isIndexedOperand(destination);
+                if (isDeadMove || isDeadPop || (isScalarStore && overwrittenStores.count(destination) > 0))
+                {
+                    removed[i] = true;
+                    if (isDeadPop)
+                    {
+                        removed[matchedPush[i]] = true;
+                    }
+                    removedAny = true;
+                    continue;
+                }
+                live = (live & ~lineDefines[i]) | lineUses[i];
+                if (isIndexedOperand(destination) || isIndexedOperand(source) || lineUses[i] == allRegisters)
+                {
+                    overwrittenStores.clear();
+                }
+                else
+                {
+                    overwrittenStores.erase(source);
+                    if (isScalarStore)
+                    {
+                        overwrittenStores.insert(destination);
+                    }
+                    else
+                    {
+                        overwrittenStores.erase(destination);
+                    }
+                }
+            }
+        }
+        removeLines(lines, removed);
+        return removedAny;
+    }
+    // Rewrites MOV AX, R / INC AX / MOV R, AX, which the lowering of ++ and --
+    // leaves behind for register variables, as INC R / MOV AX, R
+    bool foldRegisterIncrements(vector<string> &lines, int procLine, int endpLine)
+    {
+        bool changed = false;
+        vector<bool> removed(lines.size(), false);
+        for (int i = procLine + 1; i + 2 < endpLine; i++)
+        {
+            string loaded, reg, stepped, unused, stored, storedFrom;
+            bool isLoad = splitInstruction(lines[i], loaded, reg) == "MOV" && loaded == "AX";
+            string op = splitInstruction(lines[i + 1], stepped, unused);
+            bool isStep = (op == "INC" || op == "DEC") && stepped == "AX";
+            bool isStore = splitInstruction(lines[i + 2], stored, storedFrom) == "MOV" && stored == reg && storedFrom == "AX";
+            if (isLoad && isStep && isStore && getWholeRegisterMask(reg) != 0 && reg != "AX")
+            {
+                lines[i] = replaceInstruction(lines[i + 2], op + " " + reg);
+                lines[i + 1] = replaceInstruction(lines[i + 1], "MOV AX, " + reg);
+                removed[i + 2] = true;
+                changed = true;
+                i += 2;
+            }
+        }
+        removeLines(lines, removed);
+        return changed;
+    }
+    void removeLines(vector<string> &lines, vector<bool> &removed)
+    {
+        vector<string> keptLines;
+        for (int i = 0; i < lines.size(); i++)
+        {
+            if (!removed[i])
+            {
+                keptLines.push_back(lines[i]);
+            }
+        }
+        lines.swap(keptLines);
+    }
+    // Cleans up the moves left over once values sit in registers: redundant
+    // loads and stores, stack round trips and dead copies, repeated until
+    // nothing changes
+    void forwardValues(vector<string> &lines)
+    {
+        int procLine, endpLine;
+        for (int round = 0; round < 8 && findProcedure(lines, procLine, endpLine); round++)
+        {
+            bool changed = forwardBlockValues(lines, procLine, endpLine);
+            findProcedure(lines, procLine, endpLine);
+            changed = removeDeadMoves(lines, procLine, endpLine) || changed;
+            findProcedure(lines, procLine, endpLine);
+            changed = foldRegisterIncrements(lines, procLine, endpLine) || changed;
+            if (!changed)
+            {
+                break;
+            }
+        }
+    }
+    // Writes the pending code to the file. Labels are printed freely during
+    // generation and jumps are chained as the tree is lowered; both are cleaned
+    // up here, and the number of jumps threading removed is noted on the ENDP
+    // line. Layout may add jumps of its own; those are not netted against it.
+    void flushCode()
+    {
+        vector<string> lines;
+        string line;
+        istringstream code(pendingCode.str());
+        while (getline(code, line))
+        {
+            lines.push_back(line);
+        }
+        int removedJumps = 0;
+        do
+        {
+            removeDeadLabels(lines);
+        } while (threadJumps(lines, removedJumps));
+        layoutBlocks(lines);
+        do
+        {
+            removeDeadLabels(lines);
+        } while (threadJumps(lines, removedJumps));
+        allocateRegisters(lines);
+        forwardValues(lines);
+        shrinkFrame(lines);
+        if (fastCalls)
+        {
+            elideFrame(lines);
+        }
+        saveRegisters(lines);
+        for (int i = 0; i < lines.size(); i++)
+        {
+            if (removedJumps > 0 && isProcedureEnd(lines[i]))
+            {
+                lines[i] += "       ; " + to_string(removedJumps) + " branches removed";
+            }
+            asmFile << lines[i] << "\n";
+        }
+        pendingCode.str("");
+        pendingLabels.clear();
+        labelRefs.clear();
+    }
+    // Returns the left spine of a left-recursive list such as statements or
+    // program, from listNode down to the innermost node with the same rule
+    vector<ASTInternalNode *> getListSpine(ASTInternalNode *listNode)
+    {
+        vector<ASTInternalNode *> spine;
+        spine.push_back(listNode);
+        while (true)
+        {
+            ASTInternalNode *childNode = dynamic_cast<ASTInternalNode *>(getChild(spine.back(), 1));
+            if (childNode == nullptr || childNode->getKind() != listNode->getKind())
+            {
+                break;
+            }
+            spine.push_back(childNode);
+        }
+        return spine;
+    }
+    // True if the subtree under node calls a function
+    bool containsCall(ASTNode *node)
+    {
+        vector<ASTNode *> pending = {node};
+        while (!pending.empty())
+        {
+            ASTInternalNode *internalNode = dynamic_cast<ASTInternalNode *>(pending.back());
+            pending.pop_back();
+            if (internalNode == nullptr)
+            {
+                continue;
+            }
+            if (internalNode->getKind() == NodeKind::FACTOR_CALL)
+            {
+                return true;
+            }
+            for (ASTNode *child : internalNode->getChildren())
+            {
+                pending.push_back(child);
+            }
+        }
+        return false;
+    }
+    // Under --fast-calls a leaf function takes its last arguments in
+    // registers, unless a call to it was already emitted before its body
+    int chooseRegisterParamCount(string name, int paramCount, ASTNode *body)
+    {
+        int registerParamCount = 0;
+        if (fastCalls && stackCalledFunctions.count(name) == 0 && !containsCall(body))
+        {
+            registerParamCount = min(paramCount, (int)argumentRegisters.size());
+        }
+        registerParamCounts[name] = registerParamCount;
+        return registerParamCount;
+    }
+    int getRegisterArgumentCount(string calleeName)
+    {
+        auto registerParamCount = registerParamCounts.find(calleeName);
+        if (registerParamCount == registerParamCounts.end())
+        {
+            stackCalledFunctions.insert(calleeName);
+            return 0;
+        }
+        return registerParamCount->second;
+    }
+    // Parameters passed on the stack sit above the return address; those
+    // passed in registers are stored below the locals on entry
+    string getParamAddress(VariableInfo *variableInfo)
+    {
+        return getParamAddress(variableInfo->getParamOffset() / 2);
+    }
+    string getLocalAddress(VariableInfo *variableInfo)
+    {
+        return "[BP-" + to_string(localFrameBase + variableInfo->getOffset()) + "]";
+    }
+    // Address of the parameter at position (counting from 1)
+    string getParamAddress(int position)
+    {
+        int stackParamCount = funcParamCount - funcRegisterParamCount;
+        if (position > stackParamCount)
+        {
+            return "[BP-" + to_string(funcLocalSize + 2 * (position - stackParamCount)) + "]";
+        }
+        return "[BP+" + to_string(stackParamCount * 2 - 2 * position + 4) + "]";
+    }
+    int countArguments(ASTInternalNode *argumentListNode)
+    {
+        ASTInternalNode *argumentsNode = argumentListNode == nullptr ? nullptr : dynamic_cast<ASTInternalNode *>(getChild(argumentListNode, 1));
+        if (argumentsNode == nullptr)
+        {
+            return 0;
+        }
+        vector<ASTInternalNode *> spine = getListSpine(argumentsNode);
+        return argumentsNode->getKind() == NodeKind::ARGUMENTS_APPEND ? spine.size() + 1 : 1;
+    }
+    // Returns the call if expressionNode is nothing but a function call
+    ASTInternalNode *getTailCall(ASTInternalNode *expressionNode)
+    {
+        vector<NodeKind> passThroughKinds = {NodeKind::EXPRESSION_LOGIC, NodeKind::LOGIC_EXPRESSION_REL, NodeKind::REL_EXPRESSION_SIMPLE, NodeKind::SIMPLE_EXPRESSION_TERM, NodeKind::TERM_UNARY, NodeKind::UNARY_EXPRESSION_FACTOR};
+        ASTInternalNode *node = expressionNode;
+        while (node != nullptr && node->getChildCount() > 0 && find(passThroughKinds.begin(), passThroughKinds.end(), node->getKind()) != passThroughKinds.end())
+        {
+            node = dynamic_cast<ASTInternalNode *>(getChild(node, 1));
+        }
+        return node != nullptr && node->getKind() == NodeKind::FACTOR_CALL ? node : nullptr;
+    }
+    string getCalleeName(ASTInternalNode *callNode)
+    {
+        return dynamic_cast<ASTLeafNode *>(getChild(callNode, 1))->getSymbolInfo()->getName();
+    }
+    // True if some return statement under node is a tail call to funcName
+    bool hasSelfTailCall(ASTNode *node, string funcName)
+    {
+        vector<ASTNode *> pending = {node};
+        while (!pending.empty())
+        {
+            ASTInternalNode *internalNode = dynamic_cast<ASTInternalNode *>(pending.back());
+            pending.pop_back();
+            if (internalNode == nullptr)
+            {
+                continue;
+            }
+            if (internalNode->getKind() == NodeKind::STATEMENT_RETURN)
+            {
+                ASTInternalNode *callNode = getTailCall(dynamic_cast<ASTInternalNode *>(getChild(internalNode, 2)));
+                if (callNode != nullptr && getCalleeName(callNode) == funcName)
+                {
+                    return true;
+                }
+            }
+            for (ASTNode *child : internalNode->getChildren())
+            {
+                pending.push_back(child);
+            }
+        }
+        return false;
+    }
+    // Number of internal nodes under node, or -1 once it exceeds limit
+    int countNodes(ASTNode *node, int limit)
+    {
+        int count = 0;
+        vector<ASTNode *> pending = {node};
+        while (!pending.empty() && count <= limit)
+        {
+            ASTInternalNode *internalNode = dynamic_cast<ASTInternalNode *>(pending.back());
+            pending.pop_back();
+            if (internalNode == nullptr)
+            {
+                continue;
+            }
+            count++;
+            for (ASTNode *child : internalNode->getChildren())
+            {
+                pending.push_back(child);
+            }
+        }
+        return count <= limit ? count : -1;
+    }
+    ASTNode *getFunctionBody(ASTFunctionNode *functionNode)
+    {
+        int position = functionNode->getKind() == NodeKind::FUNC_DEFINITION ? 5 : 6;
+        return getChild(functionNode, position);
+    }
+    // A function is inlined if it is small, makes no calls, so cannot
+    // recurse, and keeps no arrays on the stack
+    void considerForInlining(ASTFunctionNode *functionNode)
+    {
+        string name = functionNode->getFunctionInfo()->getName();
+        ASTNode *body = getFunctionBody(functionNode);
+        if (!inlining || name == "main" || containsCall(body) || countNodes(body, inlineCalleeBudget) < 0)
+        {
+            return;
+        }
+        vector<ASTNode *> pending = {body};
+        while (!pending.empty())
+        {
+            ASTInternalNode *internalNode = dynamic_cast<ASTInternalNode *>(pending.back());
+            pending.pop_back();
+            if (internalNode == nullptr)
+            {
+                continue;
+            }
+            if (internalNode->getKind() == NodeKind::DECLARATION_LIST_ARRAY || internalNode->getKind() == NodeKind::DECLARATION_LIST_APPEND_ARRAY)
+            {
+                return;
+            }
+            for (ASTNode *child : internalNode->getChildren())
+            {
+                pending.push_back(child);
+            }
+        }
+        inlineCandidates[name] = functionNode;
+    }
+    // Picks the calls in body to inline, in source order until the caller's
+    // budget runs out, and returns the frame space their bodies need
+    int chooseInlinedCalls(ASTNode *body)
+    {
+        inlinedCalls.clear();
+        int frameSize = 0;
+        int budget = inlineCallerBudget;
+        vector<ASTNode *> pending = {body};
+        while (!pending.empty())
+        {
+            ASTInternalNode *internalNode = dynamic_cast<ASTInternalNode *>(pending.back());
+            pending.pop_back();
+            if (internalNode == nullptr)
+            {
+                continue;
+            }
+            if (internalNode->getKind() == NodeKind::FACTOR_CALL)
+            {
+                auto candidate = inlineCandidates.find(getCalleeName(internalNode));
+                if (candidate != inlineCandidates.end() && candidate->first != funcName)
+                {
+                    FunctionInfo *calleeInfo = candidate->second->getFunctionInfo();
+                    int size = countNodes(getFunctionBody(candidate->second), inlineCalleeBudget);
+                    if (size <= budget)
+                    {
+                        budget -= size;
+                        inlinedCalls.insert(internalNode);
+                        frameSize = max(frameSize, calleeInfo->getFuncStackOffset() + 2 * calleeInfo->getParameterCount());
+                    }
+                }
+            }
+            vector<ASTNode *> children;
+            for (ASTNode *child : internalNode->getChildren())
+            {
+                children.push_back(child);
+            }
+            pending.insert(pending.end(), children.rbegin(), children.rend());
+        }
+        return frameSize;
+    }
+    // Generates the body of the called function in place of the call. Its
+    // parameters and locals live below the caller's frame, and its returns
+    // jump to the end of the copy with the value in AX.
+    void genInlinedCall(ASTInternalNode *callNode)
+    {
+        ASTFunctionNode *calleeNode = inlineCandidates[getCalleeName(callNode)];
+        FunctionInfo *calleeInfo = calleeNode->getFunctionInfo();
+        ASTNode *body = getFunctionBody(calleeNode);
+        generateIntermediateCode(getChild(callNode, 3));
+        printASM("\t; inlined " + calleeInfo->getName() + " (" + to_string(countNodes(body, inlineCalleeBudget)) + " nodes)" + get_lineno_comment(callNode->getFisrtLineNo()) + "\n");
+
+        int savedParamCount = funcParamCount;
+        int savedRegisterParamCount = funcRegisterParamCount;
+        int savedLocalSize = funcLocalSize;
+        string savedReturnLabel = returnLabel;
+        bool savedReturnCalled = isReturnCalled;
+        localFrameBase = funcLocalSize + 2 * funcRegisterParamCount;
+        funcParamCount = calleeInfo->getParameterCount();
+        funcRegisterParamCount = funcParamCount;
+        funcLocalSize = localFrameBase + calleeInfo->getFuncStackOffset();
+        returnLabel = genLabel();
+        isReturnCalled = true;
+        for (int position = funcParamCount; position >= 1; position--)
+        {
+            genPOP("AX");
+            genMOV(getParamAddress(position), "AX");
+        }
+        generateIntermediateCode(body);
+        printLabel(returnLabel);
+        genPUSH("AX");
+
+        localFrameBase = 0;
+        funcParamCount = savedParamCount;
+        funcRegisterParamCount = savedRegisterParamCount;
+        funcLocalSize = savedLocalSize;
+        returnLabel = savedReturnLabel;
+        isReturnCalled = savedReturnCalled;
+    }
+    string getVariableName(VariableInfo *variableInfo)
+    {
+        return variableInfo->getName() + "@" + to_string(variableInfo->getScopeId());
+    }
+    // Canonical text of a side-effect-free integer expression and the
+    // variables and arrays it reads, or an empty key for anything else
+    pair<string, vector<ValueDependency>> &getValueKey(ASTInternalNode *node)
+    {
+        vector<pair<ASTInternalNode *, bool>> pending = {{node, false}};
+        while (!pending.empty())
+        {
+            ASTInternalNode *current = pending.back().first;
+            bool expanded = pending.back().second;
+            pending.pop_back();
+            if (valueKeys.count(current) > 0)
+            {
+                continue;
+            }
+            if (!expanded)
+            {
+                pending.push_back({current, true});
+                for (ASTNode *child : current->getChildren())
+                {
+                    ASTInternalNode *childInternalNode = dynamic_cast<ASTInternalNode *>(child);
+                    if (childInternalNode != nullptr)
+                    {
+                        pending.push_back({childInternalNode, false});
+                    }
+                }
+                continue;
+            }
+            NodeKind kind = current->getKind();
+            pair<string, vector<ValueDependency>> key;
+            if (kind == NodeKind::FACTOR_CONST_INT)
+            {
+                key.first = dynamic_cast<ASTLeafNode *>(getChild(current, 1))->getSymbolInfo()->getName();
+            }
+            else if (kind == NodeKind::VARIABLE_ID || kind == NodeKind::VARIABLE_ARRAY)
+            {
+                ASTVariableNode *variableNode = dynamic_cast<ASTVariableNode *>(current);
+                VariableInfo *variableInfo = variableNode == nullptr ? nullptr : variableNode->getVariableInfo();
+                if (variableInfo != nullptr && kind == NodeKind::VARIABLE_ID && variableInfo->getKind() == SymbolKind::VARIABLE)
+                {
+                    key.first = getVariableName(variableInfo);
+                    key.second.push_back({key.first, variableInfo->getScopeId()});
+                }
+                else if (variableInfo != nullptr && kind != NodeKind::VARIABLE_ID && variableInfo->getKind() == SymbolKind::ARRAY)
+                {
+                    key = valueKeys[dynamic_cast<ASTInternalNode *>(getChild(current, 3))];
+                    if (!key.first.empty())
+                    {
+                        key.first = getVariableName(variableInfo) + "[" + key.first + "]";
+                        key.second.push_back({getVariableName(variableInfo), variableInfo->getScopeId()});
+                    }
+                }
+            }
+            else if (kind == NodeKind::FACTOR_VARIABLE || kind == NodeKind::UNARY_EXPRESSION_FACTOR || kind == NodeKind::TERM_UNARY || kind == NodeKind::SIMPLE_EXPRESSION_TERM ||
+                     kind == NodeKind::REL_EXPRESSION_SIMPLE || kind == NodeKind::LOGIC_EXPRESSION_REL || kind == NodeKind::EXPRESSION_LOGIC)
+            {
+                key = valueKeys[dynamic_cast<ASTInternalNode *>(getChild(current, 1))];
+            }
+            else if (kind == NodeKind::FACTOR_PARENTHESIZED)
+            {
+                key = valueKeys[dynamic_cast<ASTInternalNode *>(getChild(current, 2))];
+            }
+            else if (kind == NodeKind::UNARY_EXPRESSION_ADDOP)
+            {
+                key = valueKeys[dynamic_cast<ASTInternalNode *>(getChild(current, 2))];
+                string addOp = dynamic_cast<ASTLeafNode *>(getChild(current, 1))->getSymbolInfo()->getName();
+                key.first = key.first.empty() || addOp != "-" ? "" : "-(" + key.first + ")";
+            }
+            else if (kind == NodeKind::SIMPLE_EXPRESSION_ADDOP || kind == NodeKind::TERM_MULOP)
+            {
+                pair<string, vector<ValueDependency>> &left = valueKeys[dynamic_cast<ASTInternalNode *>(getChild(current, 1))];
+                pair<string, vector<ValueDependency>> &right = valueKeys[dynamic_cast<ASTInternalNode *>(getChild(current, 3))];
+                if (!left.first.empty() && !right.first.empty())
+                {
+                    string op = dynamic_cast<ASTLeafNode *>(getChild(current, 2))->getSymbolInfo()->getName();
+                    key.first = "(" + left.first + op + right.first + ")";
+                    key.second = left.second;
+                    key.second.insert(key.second.end(), right.second.begin(), right.second.end());
+                }
+            }
+            if (key.first.size() > 256)
+            {
+                key = pair<string, vector<ValueDependency>>();
+            }
+            valueKeys[current] = key;
+        }
+        return valueKeys[node];
+    }
+    bool isValueCandidate(ASTInternalNode *node)
+    {
+        NodeKind kind = node->getKind();
+        return kind == NodeKind::SIMPLE_EXPRESSION_ADDOP || kind == NodeKind::TERM_MULOP || kind == NodeKind::VARIABLE_ARRAY;
+    }
+    // An element address is the scaled index in BX for a global array, or
+    // the offset from BP in SI for a local one
+    pair<string, vector<ValueDependency>> getAddressKey(ASTInternalNode *variableNode)
+    {
+        ArrayInfo *arrayInfo = dynamic_cast<ArrayInfo *>(dynamic_cast<ASTVariableNode *>(variableNode)->getVariableInfo());
+        pair<string, vector<ValueDependency>> key = getValueKey(dynamic_cast<ASTInternalNode *>(getChild(variableNode, 3)));
+        if (arrayInfo != nullptr && !key.first.empty())
+        {
+            key.first = (arrayInfo->getScopeId() == GLOBAL_SCOPE_ID ? "&BX:" : "&SI" + to_string(arrayInfo->getArraySize()) + ":") + key.first;
+        }
+        else
+        {
+            key.first = "";
+        }
+        return key;
     }
-
-    void genJL(string _label)
+    // Returns the temporary holding key if it was computed earlier in the
+    // block, giving the first computation a temporary to store into
+    string reuseValue(string key)
     {
-        string jl_instruction = "\tJL " + _label + "\n";
-        asmFile << jl_instruction;
+        auto availableValue = availableValues.find(key);
+        if (key.empty() || availableValue == availableValues.end())
+        {
+            return "";
+        }
+        if (availableValue->second.temp.empty())
+        {
+            availableValue->second.temp = "[BP-" + to_string(valueTempBase + 2 * (++valueTempCount)) + "]";
+            maxValueTempCount = max(maxValueTempCount, valueTempCount);
+            (key[0] == '&' ? storedAddresses : storedValues)[availableValue->second.node] = availableValue->second.temp;
+        }
+        return availableValue->second.temp;
     }
-
-    void genJLE(string _label)
+    void makeAvailable(ASTInternalNode *node, pair<string, vector<ValueDependency>> key, bool conditional)
     {
-        string jle_instruction = "\tJLE " + _label + "\n";
-        asmFile << jle_instruction;
+        if (!conditional && !key.first.empty())
+        {
+            availableValues[key.first] = {node, key.second, ""};
+        }
     }
-
-    void genJG(string _label)
+    // Forgets the values that read variableName, or any global if it is empty
+    void killValues(string variableName)
     {
-        string jg_instruction = "\tJG " + _label + "\n";
-        asmFile << jg_instruction;
+        for (auto availableValue = availableValues.begin(); availableValue != availableValues.end();)
+        {
+            bool killed = false;
+            for (ValueDependency &dependency : availableValue->second.dependencies)
+            {
+                killed = killed || dependency.name == variableName || (variableName.empty() && dependency.scopeId == GLOBAL_SCOPE_ID);
+            }
+            availableValue = killed ? availableValues.erase(availableValue) : next(availableValue);
+        }
     }
-
-    void genJGE(string _label)
+    void endValueBlock()
     {
-        string jge_instruction = "\tJGE " + _label + "\n";
-        asmFile << jge_instruction;
+        availableValues.clear();
+        valueTempCount = 0;
     }
-
-    void genJE(string _label)
+    void numberAddress(ASTInternalNode *variableNode, bool conditional)
     {
-        string je_instruction = "\tJE " + _label + "\n";
-        asmFile << je_instruction;
+        pair<string, vector<ValueDependency>> key = getAddressKey(variableNode);
+        string temp = reuseValue(key.first);
+        if (!temp.empty())
+        {
+            reusedAddresses[variableNode] = temp;
+            return;
+        }
+        numberValues(getChild(variableNode, 3), conditional);
+        makeAvailable(variableNode, key, conditional);
     }
-
-    void genJNE(string _label)
+    // Walks an expression in the order its code is generated. Values first
+    // computed where they may be skipped (the right of && and ||) are not
+    // made available.
+    void numberValues(ASTNode *node, bool conditional)
     {
-        string jne_instruction = "\tJNE " + _label + "\n";
-        asmFile << jne_instruction;
+        ASTInternalNode *internalNode = dynamic_cast<ASTInternalNode *>(node);
+        if (internalNode == nullptr)
+        {
+            return;
+        }
+        NodeKind kind = internalNode->getKind();
+        string temp = isValueCandidate(internalNode) ? reuseValue(getValueKey(internalNode).first) : "";
+        if (!temp.empty())
+        {
+            reusedValues[internalNode] = temp;
+        }
+        else if (kind == NodeKind::EXPRESSION_ASSIGN || kind == NodeKind::FACTOR_INCOP || kind == NodeKind::FACTOR_DECOP)
+        {
+            ASTVariableNode *variableNode = dynamic_cast<ASTVariableNode *>(getChild(internalNode, 1));
+            if (kind == NodeKind::EXPRESSION_ASSIGN)
+            {
+                numberValues(getChild(internalNode, 3), conditional);
+                if (variableNode->getKind() == NodeKind::VARIABLE_ARRAY)
+                {
+                    numberAddress(variableNode, conditional);
+                }
+            }
+            else
+            {
+                numberValues(variableNode, conditional);
+            }
+            if (variableNode->getVariableInfo() != nullptr)
+            {
+                killValues(getVariableName(variableNode->getVariableInfo()));
+            }
+        }
+        else if (kind == NodeKind::FACTOR_CALL)
+        {
+            numberValues(getChild(internalNode, 3), conditional);
+            killValues("");
+        }
+        else if (kind == NodeKind::LOGIC_EXPRESSION_LOGICOP)
+        {
+            numberValues(getChild(internalNode, 1), conditional);
+            numberValues(getChild(internalNode, 3), true);
+        }
+        else if (kind == NodeKind::VARIABLE_ARRAY)
+        {
+            numberAddress(internalNode, conditional);
+            makeAvailable(internalNode, getValueKey(internalNode), conditional);
+        }
+        else if (kind == NodeKind::SIMPLE_EXPRESSION_ADDOP || kind == NodeKind::TERM_MULOP)
+        {
+            // Mirrors the bottom-up emission of operator spines: evaluation
+            // starts from the innermost operand or the outermost reused part
+            vector<ASTInternalNode *> spine = getListSpine(internalNode);
+            int start = spine.size();
+            for (int i = 1; i < spine.size() && start == spine.size(); i++)
+            {
+                temp = reuseValue(getValueKey(spine[i]).first);
+                if (!temp.empty())
+                {
+                    reusedValues[spine[i]] = temp;
+                    start = i;
+                }
+            }
+            if (start == spine.size())
+            {
+                numberValues(getChild(spine.back(), 1), conditional);
+            }
+            for (int i = start - 1; i >= 0; i--)
+            {
+                numberValues(getChild(spine[i], 3), conditional);
+                makeAvailable(spine[i], getValueKey(spine[i]), conditional);
+            }
+        }
+        else
+        {
+            vector<ASTInternalNode *> spine = getListSpine(internalNode);
+            for (int i = spine.size() - 1; i >= 0; i--)
+            {
+                for (int position = i < spine.size() - 1 ? 2 : 1; position <= spine[i]->getChildCount(); position++)
+                {
+                    numberValues(getChild(spine[i], position), conditional);
+                }
+            }
+        }
     }
-
-    void genJMP(string _label)
+    // A block is a run of expression statements; any other statement ends
+    // it, and its parts are numbered as blocks of their own
+    void numberStatementValues(ASTNode *node)
     {
-        string jmp_instruction = "\tJMP " + _label + "\n";
-        asmFile << jmp_instruction;
+        ASTInternalNode *internalNode = dynamic_cast<ASTInternalNode *>(node);
+        if (internalNode == nullptr)
+        {
+            return;
+        }
+        NodeKind kind = internalNode->getKind();
+        if (kind == NodeKind::STATEMENTS_APPEND)
+        {
+            vector<ASTInternalNode *> spine = getListSpine(internalNode);
+            numberStatementValues(getChild(spine.back(), 1));
+            for (int i = spine.size() - 1; i >= 0; i--)
+            {
+                numberStatementValues(getChild(spine[i], 2));
+            }
+        }
+        else if (kind == NodeKind::COMPOUND_STATEMENT || kind == NodeKind::STATEMENTS_FIRST || kind == NodeKind::STATEMENT_EXPRESSION)
+        {
+            numberStatementValues(getChild(internalNode, kind == NodeKind::COMPOUND_STATEMENT ? 2 : 1));
+        }
+        else if (kind == NodeKind::EXPRESSION_STATEMENT)
+        {
+            numberValues(getChild(internalNode, 1), false);
+        }
+        else if (kind == NodeKind::STATEMENT_RETURN)
+        {
+            numberValues(getChild(internalNode, 2), false);
+            endValueBlock();
+        }
+        else if (kind == NodeKind::STATEMENT_IF || kind == NodeKind::STATEMENT_IF_ELSE)
+        {
+            numberValues(getChild(internalNode, 3), false);
+            for (int position = 4; position <= internalNode->getChildCount(); position++)
+            {
+                endValueBlock();
+                numberStatementValues(getChild(internalNode, position));
+            }
+            endValueBlock();
+        }
+        else if (kind != NodeKind::STATEMENT_VAR_DECLARATION && kind != NodeKind::STATEMENT_PRINTLN && kind != NodeKind::EXPRESSION_STATEMENT_EMPTY)
+        {
+            for (ASTNode *child : internalNode->getChildren())
+            {
+                endValueBlock();
+                ASTInternalNode *childInternalNode = dynamic_cast<ASTInternalNode *>(child);
+                if (childInternalNode != nullptr && (childInternalNode->getKind() == NodeKind::EXPRESSION_LOGIC || childInternalNode->getKind() == NodeKind::EXPRESSION_ASSIGN || childInternalNode->getKind() == NodeKind::EXPRESSION_ERROR))
+                {
+                    numberValues(childInternalNode, false);
+                }
+                else
+                {
+                    numberStatementValues(childInternalNode);
+                }
+            }
+            endValueBlock();
+        }
     }
-
-    void genCMP(string _reg1, string _reg2)
+    // Chooses the values of body to keep in temporaries placed from
+    // frameSize down, and returns the frame space they need
+    int chooseCommonSubexpressions(ASTNode *body, int frameSize)
     {
-        string cmp_instruction = "\tCMP " + _reg1 + ", " + _reg2 + "\n";
-        asmFile << cmp_instruction;
+        storedValues.clear();
+        reusedValues.clear();
+        storedAddresses.clear();
+        reusedAddresses.clear();
+        valueKeys.clear();
+        endValueBlock();
+        valueTempBase = frameSize;
+        maxValueTempCount = 0;
+        numberStatementValues(body);
+        endValueBlock();
+        return 2 * maxValueTempCount;
     }
-
-    void genRET(int popCount = 0)
+    // Starts an operator spine at the outermost inner node whose value is
+    // reused, or at its innermost operand, and returns where it started
+    int getFirstReusedValue(vector<ASTInternalNode *> &spine)
     {
-        if (popCount > 0)
+        for (int i = 1; i < spine.size(); i++)
         {
-            string ret_instruction = "\tRET " + to_string(popCount) + "\n";
-            asmFile << ret_instruction;
+            if (reusedValues.count(spine[i]) > 0)
+            {
+                generateIntermediateCode(spine[i]);
+                return i;
+            }
         }
-        else
+        generateIntermediateCode(getChild(spine.back(), 1));
+        return spine.size();
+    }
+    void genStoreValue(ASTInternalNode *node, string reg)
+    {
+        auto storedValue = storedValues.find(node);
+        if (storedValue != storedValues.end())
         {
-            string ret_instruction = "\tRET\n";
-            asmFile << ret_instruction;
+            genMOV(storedValue->second, reg);
         }
     }
-    string genLabel()
+    // Leaves the address of an element of arrayInfo in BX if the array is
+    // global or in SI if it is local
+    void genElementAddress(ASTVariableNode *variableNode, ArrayInfo *arrayInfo)
     {
-        string label = "L" + to_string(labelCount);
-        labelCount++;
-        return label;
+        string reg = arrayInfo->getScopeId() == GLOBAL_SCOPE_ID ? "BX" : "SI";
+        auto reusedAddress = reusedAddresses.find(variableNode);
+        if (reusedAddress != reusedAddresses.end())
+        {
+            genMOV(reg, reusedAddress->second);
+            return;
+        }
+        ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(variableNode, 3));
+        setIsCondition(expressionNode, false);
+        generateIntermediateCode(expressionNode);
+        genPOP("BX");
+        genMOV("AX", "2");
+        genMUL("BX");
+        genMOV("BX", "AX");
+        if (reg == "SI")
+        {
+            genMOV("AX", to_string(2 * arrayInfo->getArraySize()));
+            genSUB("AX", "BX");
+            genMOV("BX", "AX");
+            genMOV("SI", "BX");
+            genNEG("SI");
+        }
+        auto storedAddress = storedAddresses.find(variableNode);
+        if (storedAddress != storedAddresses.end())
+        {
+            genMOV(storedAddress->second, reg);
+        }
     }
-    void printLabel(string label)
+    // Replaces return callNode(...) by a jump. A call to the function itself
+    // overwrites the parameters and jumps back to the start of the body. Any
+    // other callee whose stack arguments fit where ours were takes over our
+    // caller's return address, so its RET goes straight back there. Returns
+    // false if the call has to be made normally.
+    bool genTailCall(ASTInternalNode *callNode)
     {
-        asmFile << label << ":" << endl;
+        ASTInternalNode *argumentListNode = dynamic_cast<ASTInternalNode *>(getChild(callNode, 3));
+        string calleeName = getCalleeName(callNode);
+        int argumentCount = countArguments(argumentListNode);
+        int stackParamCount = funcParamCount - funcRegisterParamCount;
+        if (calleeName == funcName && !funcBodyLabel.empty() && argumentCount == funcParamCount)
+        {
+            generateIntermediateCode(argumentListNode);
+            for (int position = funcParamCount; position >= 1; position--)
+            {
+                genPOP("AX");
+                genMOV(getParamAddress(position), "AX");
+            }
+            genJMP(funcBodyLabel);
+            return true;
+        }
+        if (calleeName == funcName || funcName == "main")
+        {
+            return false;
+        }
+        int registerArgumentCount = getRegisterArgumentCount(calleeName);
+        int stackArgumentCount = argumentCount - registerArgumentCount;
+        if (stackArgumentCount > stackParamCount)
+        {
+            return false;
+        }
+        generateIntermediateCode(argumentListNode);
+        clobberedArgumentCounts[funcName] = max(clobberedArgumentCounts[funcName], registerArgumentCount);
+        for (int i = registerArgumentCount - 1; i >= 0; i--)
+        {
+            genPOP(argumentRegisters[i]);
+        }
+        for (int position = stackArgumentCount; position >= 1; position--)
+        {
+            genPOP("AX");
+            genMOV("[BP+" + to_string(4 + 2 * stackParamCount - 2 * position) + "]", "AX");
+        }
+        int freedBytes = 2 * (stackParamCount - stackArgumentCount);
+        if (freedBytes > 0)
+        {
+            genMOV("AX", "[BP+2]");
+            genMOV("[BP+" + to_string(2 + freedBytes) + "]", "AX");
+        }
+        genMOV("SP", "BP");
+        genPOP("BP");
+        if (freedBytes > 0)
+        {
+            genADD("SP", to_string(freedBytes));
+        }
+        genJMP(calleeName);
+        return true;
     }
     string get_lineno_comment(int _lineno)
     {
@@ -605,8 +3231,22 @@ public:
     {
         root = nullptr;
         isCodeStarted = false;
+        fastCalls = false;
+        inlining = true;
         printLibraries = false;
     }
+    ~AST()
+    {
+        delete root;
+    }
+    void setFastCalls(bool fastCalls)
+    {
+        this->fastCalls = fastCalls;
+    }
+    void setInlining(bool inlining)
+    {
+        this->inlining = inlining;
+    }
     void setRoot(ASTNode *root)
     {
         this->root = root;
@@ -619,34 +3259,80 @@ public:
     {
         printTree(file, root, 0);
     }
+    // Pre-order walk with an explicit stack holding, for every open node, the
+    // next child still to be printed, so long statement lists cannot overflow
+    // the call stack
     void printTree(ofstream &file, ASTNode *node, int depth)
     {
-        if (node == nullptr)
-        {
-            return;
-        }
-        for (int i = 0; i < depth; i++)
-        {
-            file << " ";
-        }
-        file << node->toString() << endl;
-        ASTInternalNode *internalNode = dynamic_cast<ASTInternalNode *>(node);
-        if (internalNode != nullptr)
+        vector<pair<ASTNodeList, int>> pending;
+        pending.push_back(make_pair(ASTNodeList(&node, &node + 1), depth));
+        while (!pending.empty())
         {
-            ASTNodeList *children = internalNode->getChildren();
-            while (children != nullptr)
+            ASTNodeList entry = pending.back().first;
+            int entryDepth = pending.back().second;
+            if (entry.size() == 0)
+            {
+                pending.pop_back();
+                continue;
+            }
+            pending.back().first = ASTNodeList(entry.begin() + 1, entry.end());
+            ASTNode *current = entry[0];
+            if (current == nullptr)
+            {
+                continue;
+            }
+            for (int i = 0; i < entryDepth; i++)
             {
-                printTree(file, children->getNodePtr(), depth + 1);
-                children = children->nextNodePtr;
+                file << " ";
+            }
+            file << current->toString() << endl;
+            ASTInternalNode *internalNode = dynamic_cast<ASTInternalNode *>(current);
+            if (internalNode != nullptr)
+            {
+                pending.push_back(make_pair(internalNode->getChildren(), entryDepth + 1));
             }
         }
     }
     void generateIntermediateCode(string fileName, SymbolTable *table)
     {
-        asmFile.open(fileName);
-        generateStartingCode();
+        beginIntermediateCode(fileName);
         genetateGlobalVariables(table);
         generateIntermediateCode(root);
+        endIntermediateCode();
+    }
+    void beginIntermediateCode(string fileName)
+    {
+        asmFile.open(fileName);
+        generateStartingCode();
+    }
+    // Generates code for one top-level unit as soon as it has been parsed.
+    // Globals are emitted where they are declared, switching back to the data
+    // segment if code has already started.
+    void generateUnitCode(ASTInternalNode *unitNode, SymbolTable *table)
+    {
+        if (unitNode->getKind() == NodeKind::UNIT_VAR_DECLARATION)
+        {
+            ASTInternalNode *varDeclarationNode = dynamic_cast<ASTInternalNode *>(getChild(unitNode, 1));
+            ASTVariableNode *declarationListNode = dynamic_cast<ASTVariableNode *>(getChild(varDeclarationNode, 2));
+            if (isCodeStarted)
+            {
+                printASM(".DATA\n");
+            }
+            genetateGlobalVariables(declarationListNode, table);
+            if (isCodeStarted)
+            {
+                printASM(".CODE\n");
+            }
+        }
+        else
+        {
+            generateIntermediateCode(unitNode);
+        }
+        flushCode();
+        asmFile.flush();
+    }
+    void endIntermediateCode()
+    {
         generateEndingCode();
         asmFile.close();
     }
@@ -659,35 +3345,61 @@ public:
             SymbolInfo *symbolInfo = hashTable[i];
             while (symbolInfo != nullptr)
             {
-                if (symbolInfo->getType() == "VARIABLE")
+                genGlobalSymbol(symbolInfo);
+                symbolInfo = symbolInfo->nestSymbolInfo;
+            }
+        }
+    }
+    void genetateGlobalVariables(ASTVariableNode *declarationListNode, SymbolTable *table)
+    {
+        if (declarationListNode == nullptr || declarationListNode->isError())
+        {
+            return;
+        }
+        vector<ASTVariableNode *> declarations;
+        while (declarationListNode != nullptr)
+        {
+            declarations.push_back(declarationListNode);
+            ASTNode *child = getChild(declarationListNode, 1);
+            declarationListNode = child == nullptr ? nullptr : dynamic_cast<ASTVariableNode *>(child);
+        }
+        for (int i = declarations.size() - 1; i >= 0; i--)
+        {
+            VariableInfo *variableInfo = declarations[i]->getVariableInfo();
+            if (variableInfo != nullptr && table->LookUpCurrentScope(variableInfo->getName(), variableInfo->getNameHash()) == variableInfo)
+            {
+                genGlobalSymbol(variableInfo);
+            }
+        }
+    }
+    void genGlobalSymbol(SymbolInfo *symbolInfo)
+    {
+        if (symbolInfo->getKind() == SymbolKind::VARIABLE)
+        {
+            VariableInfo *variableInfo = dynamic_cast<VariableInfo *>(symbolInfo);
+            if (variableInfo != nullptr)
+            {
+                if (variableInfo->getScopeId() == GLOBAL_SCOPE_ID)
                 {
-                    VariableInfo *variableInfo = dynamic_cast<VariableInfo *>(symbolInfo);
-                    if (variableInfo != nullptr)
+                    if (variableInfo->getTypeSpecifier() == TYPE_INT)
                     {
-                        if (variableInfo->getScopeId() == "1")
-                        {
-                            if (variableInfo->getTypeSpecifier() == "INT")
-                            {
-                                genGlobalVar(variableInfo->getName());
-                            }
-                        }
+                        genGlobalVar(variableInfo->getName());
                     }
                 }
-                else if (symbolInfo->getType() == "ARRAY")
+            }
+        }
+        else if (symbolInfo->getKind() == SymbolKind::ARRAY)
+        {
+            ArrayInfo *arrayInfo = dynamic_cast<ArrayInfo *>(symbolInfo);
+            if (arrayInfo != nullptr)
+            {
+                if (arrayInfo->getScopeId() == GLOBAL_SCOPE_ID && arrayInfo->getArraySize() > 0)
                 {
-                    ArrayInfo *arrayInfo = dynamic_cast<ArrayInfo *>(symbolInfo);
-                    if (arrayInfo != nullptr)
+                    if (arrayInfo->getTypeSpecifier() == TYPE_INT)
                     {
-                        if (arrayInfo->getScopeId() == "1" && arrayInfo->getArraySize() > 0)
-                        {
-                            if (arrayInfo->getTypeSpecifier() == "INT")
-                            {
-                                genGlobalVar(arrayInfo->getName(), arrayInfo->getArraySize());
-                            }
-                        }
+                        genGlobalVar(arrayInfo->getName(), arrayInfo->getArraySize());
                     }
                 }
-                symbolInfo = symbolInfo->nestSymbolInfo;
             }
         }
     }
@@ -698,23 +3410,35 @@ public:
             ASTInternalNode *internalNode = dynamic_cast<ASTInternalNode *>(node);
             if (internalNode != nullptr)
             {
-                string rule = internalNode->getRule();
+                NodeKind kind = internalNode->getKind();
 
-                if (rule == "func_definition : type_specifier ID LPAREN RPAREN compound_statement")
+                if (reusedValues.count(internalNode) > 0)
+                {
+                    genMOV("AX", reusedValues[internalNode]);
+                    genPUSH("AX");
+                }
+                else if (kind == NodeKind::FUNC_DEFINITION)
                 {
                     ASTFunctionNode *functionNode = dynamic_cast<ASTFunctionNode *>(internalNode);
                     if (functionNode != nullptr)
                     {
                         isReturnCalled = false;
+                        nodeLabels.clear();
                         if (!isCodeStarted)
                         {
-                            asmFile << ".CODE" << endl;
+                            printASM(".CODE\n");
                             isCodeStarted = true;
                             labelCount = 1;
                         }
-                        string funcName = functionNode->getFunctionInfo()->getName();
+                        funcName = functionNode->getFunctionInfo()->getName();
                         int funcStackOffset = functionNode->getFunctionInfo()->getFuncStackOffset();
                         funcParamCount = functionNode->getFunctionInfo()->getParameterCount();
+                        funcLocalSize = funcStackOffset;
+                        funcRegisterParamCount = 0;
+                        clobberedArgumentCounts[funcName] = 0;
+                        ASTNode *child = getChild(internalNode, 5);
+                        funcStackOffset += chooseInlinedCalls(child);
+                        funcStackOffset += chooseCommonSubexpressions(child, funcStackOffset);
                         genPROC(funcName);
                         if (funcName == "main")
                         {
@@ -725,8 +3449,12 @@ public:
                         genMOV("BP", "SP");
                         genSUB("SP", to_string(funcStackOffset));
 
-                        ASTNodeList *child = getChild(internalNode, 5);
-                        ASTInternalNode *compoundStatementNode = dynamic_cast<ASTInternalNode *>(child->getNodePtr());
+                        funcBodyLabel = hasSelfTailCall(child, funcName) ? genLabel() : "";
+                        if (!funcBodyLabel.empty())
+                        {
+                            printLabel(funcBodyLabel);
+                        }
+                        ASTInternalNode *compoundStatementNode = dynamic_cast<ASTInternalNode *>(child);
                         if (compoundStatementNode != nullptr)
                         {
                             generateIntermediateCode(compoundStatementNode);
@@ -750,28 +3478,44 @@ public:
                             genRET(funcParamCount * 2);
                         }
                         genENDP(funcName);
+                        considerForInlining(functionNode);
                     }
                 }
-                else if (rule == "func_definition : type_specifier ID LPAREN parameter_list RPAREN compound_statement")
+                else if (kind == NodeKind::FUNC_DEFINITION_PARAMS)
                 {
                     ASTFunctionNode *functionNode = dynamic_cast<ASTFunctionNode *>(internalNode);
                     if (functionNode != nullptr)
                     {
                         isReturnCalled = false;
+                        nodeLabels.clear();
                         if (!isCodeStarted)
                         {
-                            asmFile << ".CODE" << endl;
+                            printASM(".CODE\n");
                             isCodeStarted = true;
                         }
-                        string funcName = functionNode->getFunctionInfo()->getName();
-                        int funcStackOffset = functionNode->getFunctionInfo()->getFuncStackOffset();
+                        funcName = functionNode->getFunctionInfo()->getName();
                         funcParamCount = functionNode->getFunctionInfo()->getParameterCount();
+                        funcLocalSize = functionNode->getFunctionInfo()->getFuncStackOffset();
+                        ASTNode *child = getChild(internalNode, 6);
+                        funcRegisterParamCount = chooseRegisterParamCount(funcName, funcParamCount, child);
+                        clobberedArgumentCounts[funcName] = funcRegisterParamCount;
+                        int funcStackOffset = funcLocalSize + 2 * funcRegisterParamCount;
+                        funcStackOffset += chooseInlinedCalls(child);
+                        funcStackOffset += chooseCommonSubexpressions(child, funcStackOffset);
                         genPROC(funcName);
                         genPUSH("BP");
                         genMOV("BP", "SP");
                         genSUB("SP", to_string(funcStackOffset));
-                        ASTNodeList *child = getChild(internalNode, 6);
-                        ASTInternalNode *compoundStatementNode = dynamic_cast<ASTInternalNode *>(child->getNodePtr());
+                        for (int i = 0; i < funcRegisterParamCount; i++)
+                        {
+                            genMOV("[BP-" + to_string(funcLocalSize + 2 * (i + 1)) + "]", argumentRegisters[i]);
+                        }
+                        funcBodyLabel = hasSelfTailCall(child, funcName) ? genLabel() : "";
+                        if (!funcBodyLabel.empty())
+                        {
+                            printLabel(funcBodyLabel);
+                        }
+                        ASTInternalNode *compoundStatementNode = dynamic_cast<ASTInternalNode *>(child);
                         if (compoundStatementNode != nullptr)
                         {
                             generateIntermediateCode(compoundStatementNode);
@@ -785,95 +3529,99 @@ public:
                             genADD("SP", to_string(funcStackOffset));
                         }
                         genPOP("BP");
-                        genRET(funcParamCount * 2);
+                        genRET((funcParamCount - funcRegisterParamCount) * 2);
                         genENDP(funcName);
+                        considerForInlining(functionNode);
                     }
                 }
-                else if (rule == "compound_statement : LCURL statements RCURL")
+                else if (kind == NodeKind::COMPOUND_STATEMENT)
                 {
-                    ASTInternalNode *statementListNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 2)->getNodePtr());
+                    ASTInternalNode *statementListNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 2));
                     if (statementListNode != nullptr)
                     {
-                        statementListNode->setNextLabel(internalNode->getNextLabel());
+                        setNextLabel(statementListNode, getNextLabel(internalNode));
                         generateIntermediateCode(statementListNode);
                     }
                 }
 
-                else if (rule == "statements : statements statement")
+                else if (kind == NodeKind::STATEMENTS_APPEND)
                 {
-                    ASTInternalNode *statementListNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1)->getNodePtr());
-                    ASTInternalNode *statementNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 2)->getNodePtr());
-                    if (statementListNode != nullptr && statementNode != nullptr)
+                    vector<ASTInternalNode *> spine = getListSpine(internalNode);
+                    generateIntermediateCode(getChild(spine.back(), 1));
+                    for (int i = spine.size() - 1; i >= 0; i--)
                     {
-                        generateIntermediateCode(statementListNode);
-                        string label = genLabel();
-                        statementNode->setNextLabel(label);
-                        generateIntermediateCode(statementNode);
-                        printLabel(statementNode->getNextLabel());
+                        ASTInternalNode *statementNode = dynamic_cast<ASTInternalNode *>(getChild(spine[i], 2));
+                        if (statementNode != nullptr)
+                        {
+                            string label = genLabel();
+                            setNextLabel(statementNode, label);
+                            generateIntermediateCode(statementNode);
+                            printLabel(getNextLabel(statementNode));
+                        }
                     }
                 }
-                else if (rule == "statements : statement")
+                else if (kind == NodeKind::STATEMENTS_FIRST)
                 {
-                    ASTInternalNode *statementNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1)->getNodePtr());
+                    ASTInternalNode *statementNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1));
                     if (statementNode != nullptr)
                     {
                         string label = genLabel();
-                        statementNode->setNextLabel(label);
+                        setNextLabel(statementNode, label);
                         generateIntermediateCode(statementNode);
-                        printLabel(statementNode->getNextLabel());
+                        printLabel(getNextLabel(statementNode));
                     }
                 }
-                else if (rule == "statement : expression_statement")
+                else if (kind == NodeKind::STATEMENT_EXPRESSION)
                 {
-                    ASTInternalNode *expressionStatementNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1)->getNodePtr());
+                    ASTInternalNode *expressionStatementNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1));
                     if (expressionStatementNode != nullptr)
                     {
                         string nextLabel = genLabel();
-                        expressionStatementNode->setNextLabel(nextLabel);
-                        expressionStatementNode->setIsCondition(false);
+                        setNextLabel(expressionStatementNode, nextLabel);
+                        setIsCondition(expressionStatementNode, false);
                         generateIntermediateCode(expressionStatementNode);
-                        printLabel(expressionStatementNode->getNextLabel());
+                        printLabel(getNextLabel(expressionStatementNode));
                         genPOP("AX");
                     }
                 }
-                else if (rule == "statement : compound_statement")
+                else if (kind == NodeKind::STATEMENT_COMPOUND)
                 {
-                    ASTInternalNode *compoundStatementNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1)->getNodePtr());
+                    ASTInternalNode *compoundStatementNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1));
                     if (compoundStatementNode != nullptr)
                     {
-                        compoundStatementNode->setNextLabel(internalNode->getNextLabel());
+                        setNextLabel(compoundStatementNode, getNextLabel(internalNode));
                         generateIntermediateCode(compoundStatementNode);
                     }
                 }
-                else if (rule == "statement : var_declaration")
+                else if (kind == NodeKind::STATEMENT_VAR_DECLARATION)
                 {
-                    ASTInternalNode *varDeclarationNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1)->getNodePtr());
+                    ASTInternalNode *varDeclarationNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1));
                     if (varDeclarationNode != nullptr)
                     {
-                        varDeclarationNode->setNextLabel(internalNode->getNextLabel());
+                        setNextLabel(varDeclarationNode, getNextLabel(internalNode));
                         generateIntermediateCode(varDeclarationNode);
                     }
                 }
-                else if (rule == "statement : FOR LPAREN expression_statement expression_statement expression RPAREN statement")
+                else if (kind == NodeKind::STATEMENT_FOR)
                 {
-                    ASTInternalNode *expressionStatementNode1 = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3)->getNodePtr());
-                    ASTInternalNode *expressionStatementNode2 = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 4)->getNodePtr());
-                    ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 5)->getNodePtr());
-                    ASTInternalNode *statementNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 7)->getNodePtr());
+                    ASTInternalNode *expressionStatementNode1 = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3));
+                    ASTInternalNode *expressionStatementNode2 = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 4));
+                    ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 5));
+                    ASTInternalNode *statementNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 7));
                     if (expressionStatementNode1 != nullptr && expressionStatementNode2 != nullptr && expressionNode != nullptr && statementNode != nullptr)
                     {
                         string begin = genLabel();
                         string label1 = genLabel();
                         string label2 = genLabel();
-                        expressionStatementNode1->setNextLabel(begin);
-                        expressionStatementNode2->setTrueLabel(label2);
-                        expressionStatementNode2->setFalseLabel(internalNode->getNextLabel());
-                        expressionNode->setNextLabel(begin);
-                        statementNode->setNextLabel(label1);
+                        setNextLabel(expressionStatementNode1, begin);
+                        setTrueLabel(expressionStatementNode2, label2);
+                        setFalseLabel(expressionStatementNode2, getNextLabel(internalNode));
+                        setNextLabel(expressionNode, begin);
+                        setNextLabel(statementNode, label1);
 
-                        expressionStatementNode1->setIsCondition(false);
-                        expressionStatementNode2->setIsCondition(true);
-                        expressionNode->setIsCondition(false);
+                        setIsCondition(expressionStatementNode1, false);
+                        setIsCondition(expressionStatementNode2, true);
+                        setIsCondition(expressionNode, false);
 
                         generateIntermediateCode(expressionStatementNode1);
                         genPOP("AX");
@@ -888,111 +3636,112 @@ public:
                         genJMP(label1);
                     }
                 }
-                else if (rule == "statement : IF LPAREN expression RPAREN statement")
+                else if (kind == NodeKind::STATEMENT_IF)
                 {
-                    ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3)->getNodePtr());
-                    ASTInternalNode *statementNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 5)->getNodePtr());
+                    ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3));
+                    ASTInternalNode *statementNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 5));
                     if (expressionNode != nullptr && statementNode != nullptr)
                     {
                         string label1 = genLabel();
-                        expressionNode->setTrueLabel(label1);
-                        statementNode->setNextLabel(internalNode->getNextLabel());
-                        expressionNode->setFalseLabel(statementNode->getNextLabel());
-                        expressionNode->setIsCondition(true);
+                        setTrueLabel(expressionNode, label1);
+                        setNextLabel(statementNode, getNextLabel(internalNode));
+                        setFalseLabel(expressionNode, getNextLabel(statementNode));
+                        setIsCondition(expressionNode, true);
 
                         generateIntermediateCode(expressionNode);
-                        printLabel(expressionNode->getTrueLabel());
+                        printLabel(getTrueLabel(expressionNode));
                         generateIntermediateCode(statementNode);
                     }
                 }
-                else if (rule == "statement : IF LPAREN expression RPAREN statement ELSE statement")
+                else if (kind == NodeKind::STATEMENT_IF_ELSE)
                 {
-                    ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3)->getNodePtr());
-                    ASTInternalNode *statementNode1 = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 5)->getNodePtr());
-                    ASTInternalNode *statementNode2 = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 7)->getNodePtr());
+                    ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3));
+                    ASTInternalNode *statementNode1 = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 5));
+                    ASTInternalNode *statementNode2 = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 7));
                     if (expressionNode != nullptr && statementNode1 != nullptr && statementNode2 != nullptr)
                     {
                         string label1 = genLabel();
                         string label2 = genLabel();
 
-                        expressionNode->setTrueLabel(label1);
-                        expressionNode->setFalseLabel(label2);
-                        statementNode1->setNextLabel(internalNode->getNextLabel());
-                        statementNode2->setNextLabel(internalNode->getNextLabel());
-                        expressionNode->setIsCondition(true);
+                        setTrueLabel(expressionNode, label1);
+                        setFalseLabel(expressionNode, label2);
+                        setNextLabel(statementNode1, getNextLabel(internalNode));
+                        setNextLabel(statementNode2, getNextLabel(internalNode));
+                        setIsCondition(expressionNode, true);
 
                         generateIntermediateCode(expressionNode);
-                        printLabel(expressionNode->getTrueLabel());
+                        printLabel(getTrueLabel(expressionNode));
                         generateIntermediateCode(statementNode1);
-                        genJMP(internalNode->getNextLabel());
-                        printLabel(expressionNode->getFalseLabel());
+                        genJMP(getNextLabel(internalNode));
+                        printLabel(getFalseLabel(expressionNode));
                         generateIntermediateCode(statementNode2);
                     }
                 }
-                else if (rule == "statement : WHILE LPAREN expression RPAREN statement")
+                else if (kind == NodeKind::STATEMENT_WHILE)
                 {
-                    ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3)->getNodePtr());
-                    ASTInternalNode *statementNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 5)->getNodePtr());
+                    ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3));
+                    ASTInternalNode *statementNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 5));
                     if (expressionNode != nullptr && statementNode != nullptr)
                     {
                         string begin = genLabel();
                         string label1 = genLabel();
 
-                        expressionNode->setTrueLabel(label1);
-                        expressionNode->setFalseLabel(internalNode->getNextLabel());
-                        expressionNode->setNextLabel(internalNode->getNextLabel());
-                        statementNode->setNextLabel(begin);
-                        expressionNode->setIsCondition(true);
+                        setTrueLabel(expressionNode, label1);
+                        setFalseLabel(expressionNode, getNextLabel(internalNode));
+                        setNextLabel(expressionNode, getNextLabel(internalNode));
+                        setNextLabel(statementNode, begin);
+                        setIsCondition(expressionNode, true);
 
                         printLabel(begin);
                         generateIntermediateCode(expressionNode);
-                        printLabel(expressionNode->getTrueLabel());
+                        printLabel(getTrueLabel(expressionNode));
                         generateIntermediateCode(statementNode);
                         genJMP(begin);
                     }
                 }
-                else if (rule == "statement : RETURN expression SEMICOLON")
+                else if (kind == NodeKind::STATEMENT_RETURN)
                 {
-                    ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 2)->getNodePtr());
-                    if (expressionNode != nullptr)
+                    ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 2));
+                    ASTInternalNode *callNode = getTailCall(expressionNode);
+                    if (expressionNode != nullptr && (callNode == nullptr || inlinedCalls.count(callNode) > 0 || !genTailCall(callNode)))
                     {
                         if (!isReturnCalled)
                         {
                             isReturnCalled = true;
                             returnLabel = genLabel();
                         }
-                        expressionNode->setNextLabel(internalNode->getNextLabel());
-                        expressionNode->setIsCondition(false);
+                        setNextLabel(expressionNode, getNextLabel(internalNode));
+                        setIsCondition(expressionNode, false);
                         generateIntermediateCode(expressionNode);
-                        genPOP("AX");
+                        genPOPResult();
                         genJMP(returnLabel);
                     }
                 }
 
-                else if (rule == "statement : PRINTLN LPAREN ID RPAREN SEMICOLON")
+                else if (kind == NodeKind::STATEMENT_PRINTLN)
                 {
-                    ASTLeafNode *idNode = dynamic_cast<ASTLeafNode *>(getChild(internalNode, 3)->getNodePtr());
+                    ASTLeafNode *idNode = dynamic_cast<ASTLeafNode *>(getChild(internalNode, 3));
                     if (idNode != nullptr)
                     {
                         SymbolInfo *symbolInfo = idNode->getSymbolInfo();
                         if (symbolInfo != nullptr)
                         {
-                            if (symbolInfo->getType() == "VARIABLE")
+                            if (symbolInfo->getKind() == SymbolKind::VARIABLE)
                             {
                                 VariableInfo *variableInfo = dynamic_cast<VariableInfo *>(symbolInfo);
                                 if (variableInfo != nullptr)
                                 {
-                                    if (variableInfo->getScopeId() == "1")
+                                    if (variableInfo->getScopeId() == GLOBAL_SCOPE_ID)
                                     {
                                         genMOV("AX", variableInfo->getName(), internalNode->getLastLineNo());
                                     }
                                     else if (variableInfo->getOffset() > 0)
                                     {
-                                        genMOV("AX", "[BP-" + to_string(variableInfo->getOffset()) + "]", internalNode->getLastLineNo());
+                                        genMOV("AX", getLocalAddress(variableInfo), internalNode->getLastLineNo());
                                     }
                                     else if (variableInfo->getParamOffset() > 0)
                                     {
-                                        genMOV("AX", "[BP+" + to_string(funcParamCount * 2 - variableInfo->paramOffset + 4) + "]", internalNode->getLastLineNo());
+                                        genMOV("AX", getParamAddress(variableInfo), internalNode->getLastLineNo());
                                     }
                                     genCALL("print_output");
                                     genCALL("new_line");
@@ -1005,43 +3754,43 @@ public:
                         printLibraries = true;
                     }
                 }
-                else if (rule == "expression_statement : expression SEMICOLON")
+                else if (kind == NodeKind::EXPRESSION_STATEMENT)
                 {
-                    ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1)->getNodePtr());
+                    ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1));
                     if (expressionNode != nullptr)
                     {
-                        expressionNode->setTrueLabel(internalNode->getTrueLabel());
-                        expressionNode->setFalseLabel(internalNode->getFalseLabel());
-                        expressionNode->setNextLabel(internalNode->getNextLabel());
-                        expressionNode->setIsCondition(internalNode->getIsCondition());
+                        setTrueLabel(expressionNode, getTrueLabel(internalNode));
+                        setFalseLabel(expressionNode, getFalseLabel(internalNode));
+                        setNextLabel(expressionNode, getNextLabel(internalNode));
+                        setIsCondition(expressionNode, getIsCondition(internalNode));
                         generateIntermediateCode(expressionNode);
                     }
                 }
 
-                else if (rule == "variable : ID")
+                else if (kind == NodeKind::VARIABLE_ID)
                 {
-                    ASTLeafNode *idNode = dynamic_cast<ASTLeafNode *>(getChild(internalNode, 1)->getNodePtr());
+                    ASTLeafNode *idNode = dynamic_cast<ASTLeafNode *>(getChild(internalNode, 1));
                     if (idNode != nullptr)
                     {
                         SymbolInfo *symbolInfo = idNode->getSymbolInfo();
                         if (symbolInfo != nullptr)
                         {
-                            if (symbolInfo->getType() == "VARIABLE")
+                            if (symbolInfo->getKind() == SymbolKind::VARIABLE)
                             {
                                 VariableInfo *variableInfo = dynamic_cast<VariableInfo *>(symbolInfo);
                                 if (variableInfo != nullptr)
                                 {
-                                    if (variableInfo->getScopeId() == "1")
+                                    if (variableInfo->getScopeId() == GLOBAL_SCOPE_ID)
                                     {
                                         genMOV("AX", variableInfo->getName(), internalNode->getLastLineNo());
                                     }
                                     else if (variableInfo->getOffset() > 0)
                                     {
-                                        genMOV("AX", "[BP-" + to_string(variableInfo->getOffset()) + "]", internalNode->getLastLineNo());
+                                        genMOV("AX", getLocalAddress(variableInfo), internalNode->getLastLineNo());
                                     }
                                     else if (variableInfo->getParamOffset() > 0)
                                     {
-                                        genMOV("AX", "[BP+" + to_string(funcParamCount * 2 - variableInfo->paramOffset + 4) + "]", internalNode->getLastLineNo());
+                                        genMOV("AX", getParamAddress(variableInfo), internalNode->getLastLineNo());
                                     }
                                     genPUSH("AX");
                                 }
@@ -1049,161 +3798,139 @@ public:
                         }
                     }
                 }
-                else if (rule == "variable : ID LSQUARE expression RSQUARE")
+                else if (kind == NodeKind::VARIABLE_ARRAY)
                 {
-                    ASTLeafNode *idNode = dynamic_cast<ASTLeafNode *>(getChild(internalNode, 1)->getNodePtr());
-                    ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3)->getNodePtr());
+                    ASTLeafNode *idNode = dynamic_cast<ASTLeafNode *>(getChild(internalNode, 1));
+                    ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3));
                     if (idNode != nullptr && expressionNode != nullptr)
                     {
-                        expressionNode->setIsCondition(false);
+                        setIsCondition(expressionNode, false);
                         SymbolInfo *symbolInfo = idNode->getSymbolInfo();
                         if (symbolInfo != nullptr)
                         {
-                            if (symbolInfo->getType() == "ARRAY")
+                            if (symbolInfo->getKind() == SymbolKind::ARRAY)
                             {
                                 ArrayInfo *arrayInfo = dynamic_cast<ArrayInfo *>(symbolInfo);
                                 if (arrayInfo != nullptr)
                                 {
-                                    generateIntermediateCode(expressionNode);
-                                    genPOP("BX");
-                                    genMOV("AX", "2");
-                                    genMUL("BX");
-                                    genMOV("BX", "AX");
-
-                                    if (arrayInfo->getScopeId() == "1")
+                                    genElementAddress(dynamic_cast<ASTVariableNode *>(internalNode), arrayInfo);
+                                    if (arrayInfo->getScopeId() == GLOBAL_SCOPE_ID)
                                     {
                                         genMOV("AX", arrayInfo->getName() + "[BX]");
                                     }
                                     else if (arrayInfo->getOffset() > 0)
                                     {
-                                        genMOV("AX", to_string(2 * arrayInfo->getArraySize()));
-                                        genSUB("AX", "BX");
-                                        genMOV("BX", "AX");
-                                        genMOV("SI", "BX");
-                                        genNEG("SI");
                                         genMOV("AX", "[BP+SI]");
                                     }
                                     genPUSH("AX");
+                                    genStoreValue(internalNode, "AX");
                                 }
                             }
                         }
                     }
                 }
-                else if (rule == "expression : logic_expression")
+                else if (kind == NodeKind::EXPRESSION_LOGIC)
                 {
-                    ASTInternalNode *logicExpressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1)->getNodePtr());
+                    ASTInternalNode *logicExpressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1));
                     if (logicExpressionNode != nullptr)
                     {
-                        if(internalNode->getIsCondition()){
-                            logicExpressionNode->setIsCondition(internalNode->getIsCondition());
-                            logicExpressionNode->setTrueLabel(internalNode->getTrueLabel());
-                            logicExpressionNode->setFalseLabel(internalNode->getFalseLabel());
-                            logicExpressionNode->setNextLabel(internalNode->getNextLabel());
+                        if(getIsCondition(internalNode)){
+                            setIsCondition(logicExpressionNode, getIsCondition(internalNode));
+                            setTrueLabel(logicExpressionNode, getTrueLabel(internalNode));
+                            setFalseLabel(logicExpressionNode, getFalseLabel(internalNode));
+                            setNextLabel(logicExpressionNode, getNextLabel(internalNode));
                             generateIntermediateCode(logicExpressionNode);
                         }
                         else
                         {
                             string trueLabel = genLabel();
                             string falseLabel = genLabel();
-                            logicExpressionNode->setTrueLabel(trueLabel);
-                            logicExpressionNode->setFalseLabel(falseLabel);
-                            logicExpressionNode->setNextLabel(internalNode->getNextLabel());
-                            logicExpressionNode->setIsCondition(false);
+                            setTrueLabel(logicExpressionNode, trueLabel);
+                            setFalseLabel(logicExpressionNode, falseLabel);
+                            setNextLabel(logicExpressionNode, getNextLabel(internalNode));
+                            setIsCondition(logicExpressionNode, false);
                             generateIntermediateCode(logicExpressionNode);
-                            if(!logicExpressionNode->getIsSimpleExpression()){
-                                printLabel(logicExpressionNode->getTrueLabel());
+                            if(!getIsSimpleExpression(logicExpressionNode)){
+                                printLabel(getTrueLabel(logicExpressionNode));
                                 genMOV("AX", "1");
                                 genPUSH("AX");
-                                genJMP(logicExpressionNode->getNextLabel());
-                                printLabel(logicExpressionNode->getFalseLabel());
+                                genJMP(getNextLabel(logicExpressionNode));
+                                printLabel(getFalseLabel(logicExpressionNode));
                                 genMOV("AX", "0");
                                 genPUSH("AX");
-                                genJMP(logicExpressionNode->getNextLabel());
+                                genJMP(getNextLabel(logicExpressionNode));
                             }
                         }
                     }
                 }
 
-                else if (rule == "expression : variable ASSIGNOP logic_expression")
+                else if (kind == NodeKind::EXPRESSION_ASSIGN)
                 {
-                    ASTVariableNode *variableNode = dynamic_cast<ASTVariableNode *>((getChild(internalNode, 1))->getNodePtr());
-                    ASTInternalNode *logicExpressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3)->getNodePtr());
+                    ASTVariableNode *variableNode = dynamic_cast<ASTVariableNode *>(getChild(internalNode, 1));
+                    ASTInternalNode *logicExpressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3));
                     if (variableNode != nullptr && logicExpressionNode != nullptr)
                     {
                         string nextLabel = genLabel();
                         string trueLabel = genLabel();
                         string falseLabel = genLabel();
-                        logicExpressionNode->setTrueLabel(trueLabel);
-                        logicExpressionNode->setFalseLabel(falseLabel);
-                        logicExpressionNode->setNextLabel(nextLabel);
-                        logicExpressionNode->setIsCondition(false);
+                        setTrueLabel(logicExpressionNode, trueLabel);
+                        setFalseLabel(logicExpressionNode, falseLabel);
+                        setNextLabel(logicExpressionNode, nextLabel);
+                        setIsCondition(logicExpressionNode, false);
                         generateIntermediateCode(logicExpressionNode);
-                        if(!logicExpressionNode->getIsSimpleExpression()){
-                            printLabel(logicExpressionNode->getTrueLabel());
+                        if(!getIsSimpleExpression(logicExpressionNode)){
+                            printLabel(getTrueLabel(logicExpressionNode));
                             genMOV("AX", "1");
                             genPUSH("AX");
-                            genJMP(logicExpressionNode->getNextLabel());
-                            printLabel(logicExpressionNode->getFalseLabel());
+                            genJMP(getNextLabel(logicExpressionNode));
+                            printLabel(getFalseLabel(logicExpressionNode));
                             genMOV("AX", "0");
                             genPUSH("AX");
-                            genJMP(logicExpressionNode->getNextLabel());
+                            genJMP(getNextLabel(logicExpressionNode));
                         }
-                        printLabel(logicExpressionNode->getNextLabel());
+                        printLabel(getNextLabel(logicExpressionNode));
                         VariableInfo *variableInfo = variableNode->getVariableInfo();
                         if (variableInfo != nullptr)
                         {
-                            if (variableInfo->getType() == "VARIABLE")
+                            if (variableInfo->getKind() == SymbolKind::VARIABLE)
                             {
                                 genPOP("AX");
-                                if (variableInfo->getScopeId() == "1")
+                                if (variableInfo->getScopeId() == GLOBAL_SCOPE_ID)
                                 {
                                     genMOV(variableInfo->getName(), "AX", internalNode->getLastLineNo());
                                 }
                                 else if (variableInfo->getOffset() > 0)
                                 {
-                                    genMOV("[BP-" + to_string(variableInfo->getOffset()) + "]", "AX", internalNode->getLastLineNo());
+                                    genMOV(getLocalAddress(variableInfo), "AX", internalNode->getLastLineNo());
                                 }
                                 else if (variableInfo->getParamOffset() > 0)
                                 {
-                                    genMOV("[BP+" + to_string(funcParamCount * 2 - variableInfo->paramOffset + 4) + "]", "AX", internalNode->getLastLineNo());
+                                    genMOV(getParamAddress(variableInfo), "AX", internalNode->getLastLineNo());
                                 }
                             }
-                            else if (variableInfo->getType() == "ARRAY")
+                            else if (variableInfo->getKind() == SymbolKind::ARRAY)
                             {
                                 ArrayInfo *arrayInfo = dynamic_cast<ArrayInfo *>(variableInfo);
                                 if (arrayInfo != nullptr)
                                 {
-                                    ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(variableNode, 3)->getNodePtr());
-                                    expressionNode->setIsCondition(false);
-                                    generateIntermediateCode(expressionNode);
-                                    genPOP("BX");
-                                    genMOV("AX", "2");
-                                    genMUL("BX");
-                                    genMOV("BX", "AX");
-
-                                    if (arrayInfo->getScopeId() == "1")
+                                    genElementAddress(variableNode, arrayInfo);
+                                    genPOP("AX");
+                                    if (arrayInfo->getScopeId() == GLOBAL_SCOPE_ID)
                                     {
-                                        genPOP("AX");
                                         genMOV(arrayInfo->getName() + "[BX]", "AX");
                                     }
                                     else if (arrayInfo->getOffset() > 0)
                                     {
-                                        genMOV("AX", to_string(2 * arrayInfo->getArraySize()));
-                                        genSUB("AX", "BX");
-                                        genMOV("BX", "AX");
-                                        genPOP("AX");
-                                        genMOV("SI", "BX");
-                                        genNEG("SI");
                                         genMOV("[BP+SI]", "AX");
                                     }
                                 }
                             }
-                            if (internalNode->getIsCondition())
+                            if (getIsCondition(internalNode))
                             {
                                 genPOP("AX");
                                 genCMP("AX", "0");
-                                genJNE(internalNode->getTrueLabel());
-                                genJMP(internalNode->getFalseLabel());
+                                genJNE(getTrueLabel(internalNode));
+                                genJMP(getFalseLabel(internalNode));
                             }
                             else
                             {
@@ -1212,163 +3939,170 @@ public:
                         }
                     }
                 }
-                else if (rule == "logic_expression : rel_expression LOGICOP rel_expression")
+                else if (kind == NodeKind::LOGIC_EXPRESSION_LOGICOP)
                 {
-                    ASTInternalNode *childRelExpressionNode1 = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1)->getNodePtr());
-                    ASTInternalNode *childRelExpressionNode2 = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3)->getNodePtr());
-                    string logicOp = dynamic_cast<ASTLeafNode *>(getChild(internalNode, 2)->getNodePtr())->getSymbolInfo()->getName();
+                    ASTInternalNode *childRelExpressionNode1 = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1));
+                    ASTInternalNode *childRelExpressionNode2 = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3));
+                    string logicOp = dynamic_cast<ASTLeafNode *>(getChild(internalNode, 2))->getSymbolInfo()->getName();
                     if (childRelExpressionNode1 != nullptr && childRelExpressionNode2 != nullptr)
                     {
-                        childRelExpressionNode1->setIsCondition(true);
-                        childRelExpressionNode2->setIsCondition(true);
-                        childRelExpressionNode1->setNextLabel(internalNode->getNextLabel());
-                        childRelExpressionNode2->setNextLabel(internalNode->getNextLabel());
+                        setIsCondition(childRelExpressionNode1, true);
+                        setIsCondition(childRelExpressionNode2, true);
+                        setNextLabel(childRelExpressionNode1, getNextLabel(internalNode));
+                        setNextLabel(childRelExpressionNode2, getNextLabel(internalNode));
                         string label1 = genLabel();
                         if (logicOp == "&&")
                         {
-                            childRelExpressionNode1->setTrueLabel(label1);
-                            childRelExpressionNode1->setFalseLabel(internalNode->getFalseLabel());
-                            childRelExpressionNode2->setTrueLabel(internalNode->getTrueLabel());
-                            childRelExpressionNode2->setFalseLabel(internalNode->getFalseLabel());
+                            setTrueLabel(childRelExpressionNode1, label1);
+                            setFalseLabel(childRelExpressionNode1, getFalseLabel(internalNode));
+                            setTrueLabel(childRelExpressionNode2, getTrueLabel(internalNode));
+                            setFalseLabel(childRelExpressionNode2, getFalseLabel(internalNode));
                             generateIntermediateCode(childRelExpressionNode1);
-                            printLabel(childRelExpressionNode1->getTrueLabel());
+                            printLabel(getTrueLabel(childRelExpressionNode1));
                             generateIntermediateCode(childRelExpressionNode2);
                         }
                         else if (logicOp == "||")
                         {
-                            childRelExpressionNode1->setTrueLabel(internalNode->getTrueLabel());
-                            childRelExpressionNode1->setFalseLabel(label1);
-                            childRelExpressionNode2->setTrueLabel(internalNode->getTrueLabel());
-                            childRelExpressionNode2->setFalseLabel(internalNode->getFalseLabel());
+                            setTrueLabel(childRelExpressionNode1, getTrueLabel(internalNode));
+                            setFalseLabel(childRelExpressionNode1, label1);
+                            setTrueLabel(childRelExpressionNode2, getTrueLabel(internalNode));
+                            setFalseLabel(childRelExpressionNode2, getFalseLabel(internalNode));
                             generateIntermediateCode(childRelExpressionNode1);
-                            printLabel(childRelExpressionNode1->getFalseLabel());
+                            printLabel(getFalseLabel(childRelExpressionNode1));
                             generateIntermediateCode(childRelExpressionNode2);
                         }
                     }
                 }
-                else if (rule == "logic_expression : rel_expression")
+                else if (kind == NodeKind::LOGIC_EXPRESSION_REL)
                 {
-                    ASTInternalNode *childRelExpressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1)->getNodePtr());
+                    ASTInternalNode *childRelExpressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1));
                     if (childRelExpressionNode != nullptr)
                     {
-                        childRelExpressionNode->setIsCondition(internalNode->getIsCondition());
-                        childRelExpressionNode->setNextLabel(internalNode->getNextLabel());
-                        childRelExpressionNode->setTrueLabel(internalNode->getTrueLabel());
-                        childRelExpressionNode->setFalseLabel(internalNode->getFalseLabel());
+                        setIsCondition(childRelExpressionNode, getIsCondition(internalNode));
+                        setNextLabel(childRelExpressionNode, getNextLabel(internalNode));
+                        setTrueLabel(childRelExpressionNode, getTrueLabel(internalNode));
+                        setFalseLabel(childRelExpressionNode, getFalseLabel(internalNode));
                         generateIntermediateCode(childRelExpressionNode);
-                        internalNode->setIsSimpleExpression(childRelExpressionNode->getIsSimpleExpression());
-                        internalNode->setIsNOTLogical(childRelExpressionNode->getIsNOTLogical());
+                        setIsSimpleExpression(internalNode, getIsSimpleExpression(childRelExpressionNode));
+                        setIsNOTLogical(internalNode, getIsNOTLogical(childRelExpressionNode));
                     }
                 }
 
-                else if (rule == "rel_expression : simple_expression RELOP simple_expression")
+                else if (kind == NodeKind::REL_EXPRESSION_RELOP)
                 {
-                    ASTInternalNode *childSimpleExpressionNode1 = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1)->getNodePtr());
-                    ASTInternalNode *childSimpleExpressionNode2 = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3)->getNodePtr());
-                    string relOp = dynamic_cast<ASTLeafNode *>(getChild(internalNode, 2)->getNodePtr())->getSymbolInfo()->getName();
+                    ASTInternalNode *childSimpleExpressionNode1 = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1));
+                    ASTInternalNode *childSimpleExpressionNode2 = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3));
+                    string relOp = dynamic_cast<ASTLeafNode *>(getChild(internalNode, 2))->getSymbolInfo()->getName();
                     if (childSimpleExpressionNode1 != nullptr && childSimpleExpressionNode2 != nullptr)
                     {
                         string label1 = genLabel();
                         string label2 = genLabel();
-                        childSimpleExpressionNode1->setTrueLabel(internalNode->getTrueLabel());
-                        childSimpleExpressionNode1->setFalseLabel(internalNode->getFalseLabel());
-                        childSimpleExpressionNode1->setNextLabel(label1);
-                        childSimpleExpressionNode1->setIsCondition(internalNode->getIsCondition());
+                        setTrueLabel(childSimpleExpressionNode1, getTrueLabel(internalNode));
+                        setFalseLabel(childSimpleExpressionNode1, getFalseLabel(internalNode));
+                        setNextLabel(childSimpleExpressionNode1, label1);
+                        setIsCondition(childSimpleExpressionNode1, getIsCondition(internalNode));
 
-                        childSimpleExpressionNode2->setTrueLabel(internalNode->getTrueLabel());
-                        childSimpleExpressionNode2->setFalseLabel(internalNode->getFalseLabel());
-                        childSimpleExpressionNode2->setNextLabel(label2);
-                        childSimpleExpressionNode2->setIsCondition(internalNode->getIsCondition());
+                        setTrueLabel(childSimpleExpressionNode2, getTrueLabel(internalNode));
+                        setFalseLabel(childSimpleExpressionNode2, getFalseLabel(internalNode));
+                        setNextLabel(childSimpleExpressionNode2, label2);
+                        setIsCondition(childSimpleExpressionNode2, getIsCondition(internalNode));
 
                         generateIntermediateCode(childSimpleExpressionNode1);
-                        printLabel(childSimpleExpressionNode1->getNextLabel());
+                        printLabel(getNextLabel(childSimpleExpressionNode1));
                         generateIntermediateCode(childSimpleExpressionNode2);
-                        printLabel(childSimpleExpressionNode2->getNextLabel());
+                        printLabel(getNextLabel(childSimpleExpressionNode2));
 
                         genPOP("DX", internalNode->getLastLineNo());
                         genPOP("AX", internalNode->getLastLineNo());
                         genCMP("AX", "DX");
                         if (relOp == "<")
                         {
-                            genJL(internalNode->getTrueLabel());
-                            genJMP(internalNode->getFalseLabel());
+                            genJL(getTrueLabel(internalNode));
+                            genJMP(getFalseLabel(internalNode));
                         }
                         else if (relOp == "<=")
                         {
-                            genJLE(internalNode->getTrueLabel());
-                            genJMP(internalNode->getFalseLabel());
+                            genJLE(getTrueLabel(internalNode));
+                            genJMP(getFalseLabel(internalNode));
                         }
                         else if (relOp == ">")
                         {
-                            genJG(internalNode->getTrueLabel());
-                            genJMP(internalNode->getFalseLabel());
+                            genJG(getTrueLabel(internalNode));
+                            genJMP(getFalseLabel(internalNode));
                         }
                         else if (relOp == ">=")
                         {
-                            genJGE(internalNode->getTrueLabel());
-                            genJMP(internalNode->getFalseLabel());
+                            genJGE(getTrueLabel(internalNode));
+                            genJMP(getFalseLabel(internalNode));
                         }
                         else if (relOp == "==")
                         {
-                            genJE(internalNode->getTrueLabel());
-                            genJMP(internalNode->getFalseLabel());
+                            genJE(getTrueLabel(internalNode));
+                            genJMP(getFalseLabel(internalNode));
                         }
                         else if (relOp == "!=")
                         {
-                            genJNE(internalNode->getTrueLabel());
-                            genJMP(internalNode->getFalseLabel());
+                            genJNE(getTrueLabel(internalNode));
+                            genJMP(getFalseLabel(internalNode));
                         }
                     }
                 }
-                else if (rule == "rel_expression : simple_expression")
+                else if (kind == NodeKind::REL_EXPRESSION_SIMPLE)
                 {
-                    ASTInternalNode *childSimpleExpressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1)->getNodePtr());
+                    ASTInternalNode *childSimpleExpressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1));
                     if (childSimpleExpressionNode != nullptr)
                     {
-                        childSimpleExpressionNode->setIsCondition(internalNode->getIsCondition());
-                        childSimpleExpressionNode->setTrueLabel(internalNode->getTrueLabel());
-                        childSimpleExpressionNode->setFalseLabel(internalNode->getFalseLabel());
-                        childSimpleExpressionNode->setNextLabel(internalNode->getNextLabel());
+                        setIsCondition(childSimpleExpressionNode, getIsCondition(internalNode));
+                        setTrueLabel(childSimpleExpressionNode, getTrueLabel(internalNode));
+                        setFalseLabel(childSimpleExpressionNode, getFalseLabel(internalNode));
+                        setNextLabel(childSimpleExpressionNode, getNextLabel(internalNode));
                         generateIntermediateCode(childSimpleExpressionNode);
-                        if(internalNode->getIsCondition()){
+                        if(getIsCondition(internalNode)){
                             genPOP("AX", internalNode->getLastLineNo());
                             genCMP("AX", "0");
-                            if(childSimpleExpressionNode->getIsNOTLogical()){
-                                genJE(internalNode->getTrueLabel());
-                                genJMP(internalNode->getFalseLabel());
+                            if(getIsNOTLogical(childSimpleExpressionNode)){
+                                genJE(getTrueLabel(internalNode));
+                                genJMP(getFalseLabel(internalNode));
                             }
                             else{
-                                genJNE(internalNode->getTrueLabel());
-                                genJMP(internalNode->getFalseLabel());
+                                genJNE(getTrueLabel(internalNode));
+                                genJMP(getFalseLabel(internalNode));
                             }
                         }
-                        internalNode->setIsSimpleExpression(true);
-                        internalNode->setIsNOTLogical(childSimpleExpressionNode->getIsNOTLogical());
+                        setIsSimpleExpression(internalNode, true);
+                        setIsNOTLogical(internalNode, getIsNOTLogical(childSimpleExpressionNode));
                     }
                 }
 
-                else if (rule == "simple_expression : simple_expression ADDOP term")
+                else if (kind == NodeKind::SIMPLE_EXPRESSION_ADDOP)
                 {
-                    ASTInternalNode *childSimpleExpressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1)->getNodePtr());
-                    ASTInternalNode *childTermNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3)->getNodePtr());
-                    string addOp = dynamic_cast<ASTLeafNode *>(getChild(internalNode, 2)->getNodePtr())->getSymbolInfo()->getName();
-                    if (childSimpleExpressionNode != nullptr && childTermNode != nullptr)
+                    // a + b + c + ... is a left spine; label it top-down, then
+                    // emit it bottom-up without recursing per operator
+                    vector<ASTInternalNode *> spine = getListSpine(internalNode);
+                    for (int i = 0; i < spine.size(); i++)
                     {
+                        ASTInternalNode *childSimpleExpressionNode = dynamic_cast<ASTInternalNode *>(getChild(spine[i], 1));
+                        ASTInternalNode *childTermNode = dynamic_cast<ASTInternalNode *>(getChild(spine[i], 3));
                         string simpleExpressionNextLabel = genLabel();
-                        childSimpleExpressionNode->setIsCondition(false);
-                        childSimpleExpressionNode->setNextLabel(simpleExpressionNextLabel);
+                        setIsCondition(childSimpleExpressionNode, false);
+                        setNextLabel(childSimpleExpressionNode, simpleExpressionNextLabel);
 
                         string termNextLabel = genLabel();
-                        childTermNode->setIsCondition(false);
-                        childTermNode->setNextLabel(termNextLabel);
-
-                        generateIntermediateCode(childSimpleExpressionNode);
-                        printLabel(childSimpleExpressionNode->getNextLabel());
+                        setIsCondition(childTermNode, false);
+                        setNextLabel(childTermNode, termNextLabel);
+                    }
+                    int start = getFirstReusedValue(spine);
+                    for (int i = start - 1; i >= 0; i--)
+                    {
+                        ASTInternalNode *childSimpleExpressionNode = dynamic_cast<ASTInternalNode *>(getChild(spine[i], 1));
+                        ASTInternalNode *childTermNode = dynamic_cast<ASTInternalNode *>(getChild(spine[i], 3));
+                        string addOp = dynamic_cast<ASTLeafNode *>(getChild(spine[i], 2))->getSymbolInfo()->getName();
+                        printLabel(getNextLabel(childSimpleExpressionNode));
                         generateIntermediateCode(childTermNode);
-                        printLabel(childTermNode->getNextLabel());
+                        printLabel(getNextLabel(childTermNode));
 
-                        genPOP("DX", internalNode->getLastLineNo());
-                        genPOP("AX", internalNode->getLastLineNo());
+                        genPOP("DX", spine[i]->getLastLineNo());
+                        genPOP("AX", spine[i]->getLastLineNo());
                         if (addOp == "+"){
                             genADD("AX", "DX");
                         }
@@ -1376,57 +4110,63 @@ public:
                             genSUB("AX", "DX");
                         }
                         genPUSH("AX");
+                        genStoreValue(spine[i], "AX");
                     }
                 }
-                else if (rule == "simple_expression : term")
+                else if (kind == NodeKind::SIMPLE_EXPRESSION_TERM)
                 {
-                    ASTInternalNode *childTermNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1)->getNodePtr());
+                    ASTInternalNode *childTermNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1));
                     if (childTermNode != nullptr)
                     {
-                        childTermNode->setIsCondition(internalNode->getIsCondition());
-                        childTermNode->setTrueLabel(internalNode->getTrueLabel());
-                        childTermNode->setFalseLabel(internalNode->getFalseLabel());
-                        childTermNode->setNextLabel(internalNode->getNextLabel());
+                        setIsCondition(childTermNode, getIsCondition(internalNode));
+                        setTrueLabel(childTermNode, getTrueLabel(internalNode));
+                        setFalseLabel(childTermNode, getFalseLabel(internalNode));
+                        setNextLabel(childTermNode, getNextLabel(internalNode));
                         generateIntermediateCode(childTermNode);
-                        internalNode->setIsNOTLogical(childTermNode->getIsNOTLogical());
+                        setIsNOTLogical(internalNode, getIsNOTLogical(childTermNode));
                     }
                 }
-                else if (rule == "term : unary_expression")
+                else if (kind == NodeKind::TERM_UNARY)
                 {
-                    ASTInternalNode *unary_expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1)->getNodePtr());
+                    ASTInternalNode *unary_expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1));
                     if (unary_expressionNode != nullptr)
                     {
-                        unary_expressionNode->setIsCondition(internalNode->getIsCondition());
-                        unary_expressionNode->setTrueLabel(internalNode->getTrueLabel());
-                        unary_expressionNode->setFalseLabel(internalNode->getFalseLabel());
-                        unary_expressionNode->setNextLabel(internalNode->getNextLabel());
+                        setIsCondition(unary_expressionNode, getIsCondition(internalNode));
+                        setTrueLabel(unary_expressionNode, getTrueLabel(internalNode));
+                        setFalseLabel(unary_expressionNode, getFalseLabel(internalNode));
+                        setNextLabel(unary_expressionNode, getNextLabel(internalNode));
                         generateIntermediateCode(unary_expressionNode);
-                        internalNode->setIsNOTLogical(unary_expressionNode->getIsNOTLogical());
+                        setIsNOTLogical(internalNode, getIsNOTLogical(unary_expressionNode));
                     }
                 }
 
-                else if (rule == "term : term MULOP unary_expression")
+                else if (kind == NodeKind::TERM_MULOP)
                 {
-                    ASTInternalNode *childTerm = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1)->getNodePtr());
-                    ASTInternalNode *unary_expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3)->getNodePtr());
-                    string mulOp = dynamic_cast<ASTLeafNode *>(getChild(internalNode, 2)->getNodePtr())->getSymbolInfo()->getName();
-                    if (childTerm != nullptr && unary_expressionNode != nullptr)
+                    vector<ASTInternalNode *> spine = getListSpine(internalNode);
+                    for (int i = 0; i < spine.size(); i++)
                     {
+                        ASTInternalNode *childTerm = dynamic_cast<ASTInternalNode *>(getChild(spine[i], 1));
+                        ASTInternalNode *unary_expressionNode = dynamic_cast<ASTInternalNode *>(getChild(spine[i], 3));
                         string termNextLabel = genLabel();
-                        childTerm->setIsCondition(false);
-                        childTerm->setNextLabel(termNextLabel);
+                        setIsCondition(childTerm, false);
+                        setNextLabel(childTerm, termNextLabel);
 
                         string unary_expressionNextLabel = genLabel();
-                        unary_expressionNode->setIsCondition(false);
-                        unary_expressionNode->setNextLabel(unary_expressionNextLabel);
-
-                        generateIntermediateCode(childTerm);
-                        printLabel(childTerm->getNextLabel());
+                        setIsCondition(unary_expressionNode, false);
+                        setNextLabel(unary_expressionNode, unary_expressionNextLabel);
+                    }
+                    int start = getFirstReusedValue(spine);
+                    for (int i = start - 1; i >= 0; i--)
+                    {
+                        ASTInternalNode *childTerm = dynamic_cast<ASTInternalNode *>(getChild(spine[i], 1));
+                        ASTInternalNode *unary_expressionNode = dynamic_cast<ASTInternalNode *>(getChild(spine[i], 3));
+                        string mulOp = dynamic_cast<ASTLeafNode *>(getChild(spine[i], 2))->getSymbolInfo()->getName();
+                        printLabel(getNextLabel(childTerm));
                         generateIntermediateCode(unary_expressionNode);
-                        printLabel(unary_expressionNode->getNextLabel());
+                        printLabel(getNextLabel(unary_expressionNode));
                         
-                        genPOP("CX", internalNode->getLastLineNo());
-                        genPOP("AX", internalNode->getLastLineNo());
+                        genPOP("CX", spine[i]->getLastLineNo());
+                        genPOP("AX", spine[i]->getLastLineNo());
                         genCWD();
                         if (mulOp == "*")
                         {
@@ -1443,45 +4183,46 @@ public:
                             genDIV("CX");
                             genPUSH("DX");
                         }
+                        genStoreValue(spine[i], mulOp == "%" ? "DX" : "AX");
                     }
                 }
-                else if (rule == "unary_expression : ADDOP unary_expression")
+                else if (kind == NodeKind::UNARY_EXPRESSION_ADDOP)
                 {
-                    ASTLeafNode *addOpNode = dynamic_cast<ASTLeafNode *>(getChild(internalNode, 1)->getNodePtr());
+                    ASTLeafNode *addOpNode = dynamic_cast<ASTLeafNode *>(getChild(internalNode, 1));
                     if (addOpNode != nullptr)
                     {
                         string addOp = addOpNode->getSymbolInfo()->getName();
                         if (addOp == "-")
                         {
-                            ASTInternalNode *unaryExpressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 2)->getNodePtr());
+                            ASTInternalNode *unaryExpressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 2));
                             if (unaryExpressionNode != nullptr)
                             {
                                 string label1 = genLabel();
-                                unaryExpressionNode->setIsCondition(false);
-                                unaryExpressionNode->setIsCondition(internalNode->getIsCondition());
-                                unaryExpressionNode->setNextLabel(label1);
+                                setIsCondition(unaryExpressionNode, false);
+                                setIsCondition(unaryExpressionNode, getIsCondition(internalNode));
+                                setNextLabel(unaryExpressionNode, label1);
                                 generateIntermediateCode(unaryExpressionNode);
-                                printLabel(unaryExpressionNode->getNextLabel());
+                                printLabel(getNextLabel(unaryExpressionNode));
                                 genPOP("AX");
                                 genNEG("AX");
                                 genPUSH("AX");
-                                genJMP(internalNode->getNextLabel());
+                                genJMP(getNextLabel(internalNode));
                             }
                         }
                     }
                 }
-                else if (rule == "unary_expression : NOT unary_expression")
+                else if (kind == NodeKind::UNARY_EXPRESSION_NOT)
                 {
-                    ASTInternalNode *unaryExpressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 2)->getNodePtr());
+                    ASTInternalNode *unaryExpressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 2));
                     if (unaryExpressionNode != nullptr)
                     {
                         string label = genLabel();
-                        internalNode->setIsNOTLogical(true);
-                        unaryExpressionNode->setNextLabel(label);
-                        unaryExpressionNode->setIsCondition(false);
+                        setIsNOTLogical(internalNode, true);
+                        setNextLabel(unaryExpressionNode, label);
+                        setIsCondition(unaryExpressionNode, false);
                         generateIntermediateCode(unaryExpressionNode);
-                        printLabel(unaryExpressionNode->getNextLabel());
-                        if(!internalNode->getIsCondition())
+                        printLabel(getNextLabel(unaryExpressionNode));
+                        if(!getIsCondition(internalNode))
                         {  
                             string trueLabel = genLabel();
                             string falseLabel = genLabel();
@@ -1492,66 +4233,77 @@ public:
                             printLabel(trueLabel);
                             genMOV("AX", "0");
                             genPUSH("AX");
-                            genJMP(internalNode->getNextLabel());
+                            genJMP(getNextLabel(internalNode));
                             printLabel(falseLabel);
                             genMOV("AX", "1");
                             genPUSH("AX");
-                            genJMP(internalNode->getNextLabel());
+                            genJMP(getNextLabel(internalNode));
                         }
                     }
                 }
-                else if (rule == "unary_expression : factor")
+                else if (kind == NodeKind::UNARY_EXPRESSION_FACTOR)
                 {
-                    ASTInternalNode *factorNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1)->getNodePtr());
+                    ASTInternalNode *factorNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 1));
                     if (factorNode != nullptr)
                     {
-                        factorNode->setIsCondition(internalNode->getIsCondition());
-                        factorNode->setTrueLabel(internalNode->getTrueLabel());
-                        factorNode->setFalseLabel(internalNode->getFalseLabel());
-                        factorNode->setNextLabel(internalNode->getNextLabel());
+                        setIsCondition(factorNode, getIsCondition(internalNode));
+                        setTrueLabel(factorNode, getTrueLabel(internalNode));
+                        setFalseLabel(factorNode, getFalseLabel(internalNode));
+                        setNextLabel(factorNode, getNextLabel(internalNode));
                         generateIntermediateCode(factorNode);
                     }
                 }
-                else if (rule == "factor : LPAREN expression RPAREN")
+                else if (kind == NodeKind::FACTOR_PARENTHESIZED)
                 {
-                    ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 2)->getNodePtr());
+                    ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 2));
                     if (expressionNode != nullptr)
                     {
-                        expressionNode->setIsCondition(internalNode->getIsCondition());
-                        expressionNode->setTrueLabel(internalNode->getTrueLabel());
-                        expressionNode->setFalseLabel(internalNode->getFalseLabel());
-                        expressionNode->setNextLabel(internalNode->getNextLabel());
+                        setIsCondition(expressionNode, getIsCondition(internalNode));
+                        setTrueLabel(expressionNode, getTrueLabel(internalNode));
+                        setFalseLabel(expressionNode, getFalseLabel(internalNode));
+                        setNextLabel(expressionNode, getNextLabel(internalNode));
                         generateIntermediateCode(expressionNode);                      
                     }
                 }
 
-                else if (rule == "factor : ID LPAREN argument_list RPAREN")
+                else if (kind == NodeKind::FACTOR_CALL)
                 {
-                    ASTInternalNode *argument_listNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3)->getNodePtr());
-                    generateIntermediateCode(argument_listNode);
-                    string funcName = dynamic_cast<ASTLeafNode *>(getChild(internalNode, 1)->getNodePtr())->getSymbolInfo()->getName();
-                    genCALL(funcName);
-                    genPUSH("AX");
+                    if (inlinedCalls.count(internalNode) > 0)
+                    {
+                        genInlinedCall(internalNode);
+                    }
+                    else
+                    {
+                        ASTInternalNode *argument_listNode = dynamic_cast<ASTInternalNode *>(getChild(internalNode, 3));
+                        generateIntermediateCode(argument_listNode);
+                        string calleeName = getCalleeName(internalNode);
+                        for (int i = getRegisterArgumentCount(calleeName) - 1; i >= 0; i--)
+                        {
+                            genPOP(argumentRegisters[i]);
+                        }
+                        genCALL(calleeName);
+                        genPUSH("AX");
+                    }
                 }
-                else if (rule == "factor : variable INCOP")
+                else if (kind == NodeKind::FACTOR_INCOP)
                 {
-                    ASTVariableNode *variableNode = dynamic_cast<ASTVariableNode *>((getChild(internalNode, 1))->getNodePtr());
-                    generateIntermediateCode(getChild(internalNode, 1)->getNodePtr());
+                    ASTVariableNode *variableNode = dynamic_cast<ASTVariableNode *>(getChild(internalNode, 1));
+                    generateIntermediateCode(getChild(internalNode, 1));
                     genINC("AX");
                     genPUSH("AX");
                     generateCodeForVarAssign(variableNode);
                 }
-                else if (rule == "factor : variable DECOP")
+                else if (kind == NodeKind::FACTOR_DECOP)
                 {
-                    ASTVariableNode *variableNode = dynamic_cast<ASTVariableNode *>((getChild(internalNode, 1))->getNodePtr());
-                    generateIntermediateCode(getChild(internalNode, 1)->getNodePtr());
+                    ASTVariableNode *variableNode = dynamic_cast<ASTVariableNode *>(getChild(internalNode, 1));
+                    generateIntermediateCode(getChild(internalNode, 1));
                     genDEC("AX");
                     genPUSH("AX");
                     generateCodeForVarAssign(variableNode);
                 }
-                else if (rule == "factor : CONST_INT")
+                else if (kind == NodeKind::FACTOR_CONST_INT)
                 {
-                    ASTLeafNode *constIntNode = dynamic_cast<ASTLeafNode *>(getChild(internalNode, 1)->getNodePtr());
+                    ASTLeafNode *constIntNode = dynamic_cast<ASTLeafNode *>(getChild(internalNode, 1));
                     if (constIntNode != nullptr)
                     {
                         genMOV("AX", constIntNode->getSymbolInfo()->getName(), internalNode->getLastLineNo());
@@ -1560,16 +4312,25 @@ public:
                 }
                 else
                 {
-                    ASTNodeList *children = internalNode->getChildren();
-                    while (children != nullptr)
+                    // Left-recursive lists (program, arguments, ...) are walked
+                    // bottom-up along their spine instead of recursing per element
+                    vector<ASTInternalNode *> spine = getListSpine(internalNode);
+                    for (int i = 1; i < spine.size(); i++)
+                    {
+                        setNextLabel(spine[i], getNextLabel(internalNode));
+                    }
+                    for (int i = spine.size() - 1; i >= 0; i--)
                     {
-                        ASTInternalNode *childInternalNode = dynamic_cast<ASTInternalNode *>(children->getNodePtr());
-                        if (childInternalNode != nullptr)
+                        for (int position = i < spine.size() - 1 ? 2 : 1; position <= spine[i]->getChildCount(); position++)
                         {
-                            childInternalNode->setNextLabel(internalNode->getNextLabel());
+                            ASTNode *child = getChild(spine[i], position);
+                            ASTInternalNode *childInternalNode = dynamic_cast<ASTInternalNode *>(child);
+                            if (childInternalNode != nullptr)
+                            {
+                                setNextLabel(childInternalNode, getNextLabel(spine[i]));
+                            }
+                            generateIntermediateCode(child);
                         }
-                        generateIntermediateCode(children->getNodePtr());
-                        children = children->nextNodePtr;
                     }
                 }
             }
@@ -1580,47 +4341,35 @@ public:
         VariableInfo *variableInfo = variableNode->getVariableInfo();
         if (variableInfo != nullptr)
         {
-            if (variableInfo->getType() == "VARIABLE")
+            if (variableInfo->getKind() == SymbolKind::VARIABLE)
             {
                 genPOP("AX");
-                if (variableInfo->getScopeId() == "1")
+                if (variableInfo->getScopeId() == GLOBAL_SCOPE_ID)
                 {
                     genMOV(variableInfo->getName(), "AX", variableNode->getLastLineNo());
                 }
                 else if (variableInfo->getOffset() > 0)
                 {
-                    genMOV("[BP-" + to_string(variableInfo->getOffset()) + "]", "AX", variableNode->getLastLineNo());
+                    genMOV(getLocalAddress(variableInfo), "AX", variableNode->getLastLineNo());
                 }
                 else if (variableInfo->getParamOffset() > 0)
                 {
-                    genMOV("[BP+" + to_string(funcParamCount * 2 - variableInfo->paramOffset + 4) + "]", "AX", variableNode->getLastLineNo());
+                    genMOV(getParamAddress(variableInfo), "AX", variableNode->getLastLineNo());
                 }
             }
-            else if (variableInfo->getType() == "ARRAY")
+            else if (variableInfo->getKind() == SymbolKind::ARRAY)
             {
                 ArrayInfo *arrayInfo = dynamic_cast<ArrayInfo *>(variableInfo);
                 if (arrayInfo != nullptr)
                 {
-                    ASTInternalNode *expressionNode = dynamic_cast<ASTInternalNode *>(getChild(variableNode, 3)->getNodePtr());
-                    generateIntermediateCode(expressionNode);
-                    genPOP("BX");
-                    genMOV("AX", "2");
-                    genMUL("BX");
-                    genMOV("BX", "AX");
-
-                    if (arrayInfo->getScopeId() == "1")
+                    genElementAddress(variableNode, arrayInfo);
+                    genPOP("AX");
+                    if (arrayInfo->getScopeId() == GLOBAL_SCOPE_ID)
                     {
-                        genPOP("AX");
                         genMOV(arrayInfo->getName() + "[BX]", "AX");
                     }
                     else if (arrayInfo->getOffset() > 0)
                     {
-                        genMOV("AX", to_string(2 * arrayInfo->getArraySize()));
-                        genSUB("AX", "BX");
-                        genMOV("BX", "AX");
-                        genPOP("AX");
-                        genMOV("SI", "BX");
-                        genNEG("SI");
                         genMOV("[BP+SI]", "AX");
                     }
                 }
@@ -2,43 +2,134 @@
 
 #include <iostream>
 #include <fstream>
+#include <vector>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include "../../SymbolTable/2005021_HashPolicy.h"
 
 using namespace std;
 
+// Hash policy for symbol names. The hash is not confined to ScopeTable: each
+// identifier is hashed once, when it is scanned, and the result is kept on
+// its SymbolInfo and reused by every scope probe and by the code generator's
+// lookups, so the policy is picked here rather than as a ScopeTable
+// parameter. The bucket a name lands in decides the order of the scope
+// dumps in log.txt.
+typedef SdbmHash SymbolNameHash;
+
+inline unsigned long long hashSymbolName(string_view name)
+{
+    return SymbolNameHash()(name);
+}
+
+// What a SymbolInfo stands for: the token it was scanned as, or, once
+// declared, a variable, an array or a function
+enum class SymbolKind : unsigned char
+{
+    IF, ELSE, FOR, WHILE, RETURN, PRINTLN,
+    INT, FLOAT, VOID,
+    ID, CONST_INT, CONST_FLOAT,
+    ADDOP, MULOP, INCOP, DECOP, RELOP, ASSIGNOP, LOGICOP, NOT,
+    LPAREN, RPAREN, LCURL, RCURL, LSQUARE, RSQUARE, COMMA, SEMICOLON,
+    VARIABLE, ARRAY, FUNCTION
+};
+
+inline const char *getSymbolKindName(SymbolKind kind)
+{
+    static const char *const names[] = {
+        "IF", "ELSE", "FOR", "WHILE", "RETURN", "PRINTLN",
+        "INT", "FLOAT", "VOID",
+        "ID", "CONST_INT", "CONST_FLOAT",
+        "ADDOP", "MULOP", "INCOP", "DECOP", "RELOP", "ASSIGNOP", "LOGICOP", "NOT",
+        "LPAREN", "RPAREN", "LCURL", "RCURL", "LSQUARE", "RSQUARE", "COMMA", "SEMICOLON",
+        "VARIABLE", "ARRAY", "FUNCTION"};
+    return names[(int)kind];
+}
+
+// Types are interned: there is exactly one descriptor per type, so type checks
+// compare pointers. The name is only read for logs and diagnostics.
+struct TypeDescriptor
+{
+    const char *name;
+    int dataSize;
+};
+
+inline constexpr TypeDescriptor typeDescriptors[] = {{"UNDEFINED", 0}, {"INT", 2}, {"FLOAT", 4}, {"VOID", 0}};
+inline constexpr const TypeDescriptor *TYPE_UNDEFINED = &typeDescriptors[0];
+inline constexpr const TypeDescriptor *TYPE_INT = &typeDescriptors[1];
+inline constexpr const TypeDescriptor *TYPE_FLOAT = &typeDescriptors[2];
+inline constexpr const TypeDescriptor *TYPE_VOID = &typeDescriptors[3];
+
+// Scopes are numbered in the order they are opened, so the global scope is
+// always the first. Codegen tests this on every variable access.
+inline constexpr int GLOBAL_SCOPE_ID = 1;
+
 class SymbolInfo
 {
 protected:
     string name;
-    string type;
-    string scopeId;
+    SymbolKind kind;
+    int scopeId;
+    unsigned long long nameHash;
+    bool isNameHashed;
 
 public:
     int offset;
     int paramOffset;
     SymbolInfo *nestSymbolInfo;
-    SymbolInfo(string name, string type)
+    SymbolInfo(string name, SymbolKind kind)
     {
         this->name = name;
-        this->type = type;
+        this->kind = kind;
+        this->scopeId = 0;
         this->offset = -1;
         this->paramOffset = -1;
         this->nestSymbolInfo = nullptr;
+        this->isNameHashed = false;
+    }
+    virtual ~SymbolInfo()
+    {
     }
     void setName(string name)
     {
         this->name = name;
+        this->isNameHashed = false;
     }
-    string getName()
+    const string &getName()
     {
         return this->name;
     }
-    void setType(string type)
+    // Hashes the name now instead of on the first scope probe
+    void hashName()
+    {
+        this->nameHash = hashSymbolName(name);
+        this->isNameHashed = true;
+    }
+    unsigned long long getNameHash()
+    {
+        if (!isNameHashed)
+        {
+            hashName();
+        }
+        return this->nameHash;
+    }
+    // Compares the hashes first, so a chain walk rarely touches the strings
+    bool isNamed(string_view symbolName, unsigned long long symbolNameHash)
+    {
+        return getNameHash() == symbolNameHash && name == symbolName;
+    }
+    void setKind(SymbolKind kind)
+    {
+        this->kind = kind;
+    }
+    SymbolKind getKind()
     {
-        this->type = type;
+        return this->kind;
     }
-    string getType()
+    const char *getKindName()
     {
-        return this->type;
+        return getSymbolKindName(kind);
     }
     void setOffset(int offset)
     {
@@ -48,11 +139,11 @@ public:
     {
         return this->offset;
     }
-    void setScopeId(string scopeId)
+    void setScopeId(int scopeId)
     {
         this->scopeId = scopeId;
     }
-    string getScopeId()
+    int getScopeId()
     {
         return this->scopeId;
     }
@@ -67,31 +158,31 @@ public:
 
     virtual string toString()
     {
-        return "<" + name + "," + type + ">";
+        return "<" + name + "," + getKindName() + ">";
     }
 };
 
 class VariableInfo : public SymbolInfo
 {
 protected:
-    string typeSspecifier;
+    const TypeDescriptor *typeSpecifier;
 
 public:
-    VariableInfo(string name, string typeSspecifier = "UNDEFINED", string type = "VARIABLE") : SymbolInfo(name, type)
+    VariableInfo(string name, const TypeDescriptor *typeSpecifier = TYPE_UNDEFINED, SymbolKind kind = SymbolKind::VARIABLE) : SymbolInfo(name, kind)
     {
-        this->typeSspecifier = typeSspecifier;
+        this->typeSpecifier = typeSpecifier;
     }
-    string getTypeSpecifier()
+    const TypeDescriptor *getTypeSpecifier()
     {
-        return this->typeSspecifier;
+        return this->typeSpecifier;
     }
-    void setTypeSpecifier(string typeSspecifier)
+    void setTypeSpecifier(const TypeDescriptor *typeSpecifier)
     {
-        this->typeSspecifier = typeSspecifier;
+        this->typeSpecifier = typeSpecifier;
     }
     virtual string toString()
     {
-        return "<" + name + "," + typeSspecifier + ">";
+        return "<" + name + "," + typeSpecifier->name + ">";
     }
 };
 
@@ -101,7 +192,7 @@ protected:
     int arraySize;
 
 public:
-    ArrayInfo(string name, int arraySize, string typeSspecifier = "UNDEFINED", string type = "ARRAY") : VariableInfo(name, typeSspecifier, type)
+    ArrayInfo(string name, int arraySize, const TypeDescriptor *typeSpecifier = TYPE_UNDEFINED, SymbolKind kind = SymbolKind::ARRAY) : VariableInfo(name, typeSpecifier, kind)
     {
         this->arraySize = arraySize;
     }
@@ -111,61 +202,77 @@ public:
     }
     virtual string toString()
     {
-        return "<" + name + "," + type + ">";
+        return "<" + name + "," + getKindName() + ">";
+    }
+};
+
+// Key of the scoped-binding index: a view of a symbol's name together with
+// its precomputed hash, which is all the index ever hashes
+struct SymbolKey
+{
+    string_view name;
+    unsigned long long hash;
+
+    bool operator==(const SymbolKey &other) const
+    {
+        return hash == other.hash && name == other.name;
+    }
+};
+
+struct SymbolKeyHash
+{
+    size_t operator()(const SymbolKey &symbolKey) const
+    {
+        return symbolKey.hash;
     }
 };
 
+// Parameters, declarators or call arguments in source order. The names are
+// indexed for the redefinition checks, and a running hash of the type
+// specifiers lets most mismatched signatures be rejected without a walk.
 class VariableList
 {
 private:
-    int size;
-    VariableInfo *list;
-    VariableInfo *lastVariable;
+    vector<VariableInfo *> variables;
+    unordered_set<SymbolKey, SymbolKeyHash> names;
+    // Covers the types the variables had when they were added, which for
+    // parameters and arguments are their final ones
+    unsigned long long signatureHash;
 
 public:
     VariableList()
     {
-        this->size = 0;
-        this->list = nullptr;
-        this->lastVariable = nullptr;
+        this->signatureHash = 0;
     }
     void addVariable(VariableInfo *variableInfo)
     {
-        if (list == nullptr)
-        {
-            this->list = variableInfo;
-            this->lastVariable = list;
-        }
-        else
-        {
-            this->lastVariable->nestSymbolInfo = variableInfo;
-            this->lastVariable = (VariableInfo *)lastVariable->nestSymbolInfo;
-        }
-        size++;
+        variables.push_back(variableInfo);
+        names.insert({variableInfo->getName(), variableInfo->getNameHash()});
+        signatureHash = signatureHash * 31 + (variableInfo->getTypeSpecifier() - typeDescriptors) + 1;
     }
     int getSize()
     {
-        return size;
+        return variables.size();
     }
-    VariableInfo *getHead()
+    const vector<VariableInfo *> &getVariables()
     {
-        return list;
+        return variables;
     }
-    bool findVariable(string variableName)
+    VariableInfo *getVariable(int index)
     {
-        VariableInfo *listIterator = list;
-        while (listIterator != nullptr)
-        {
-            if (listIterator->getName() == variableName)
-            {
-                return true;
-            }
-            else
-            {
-                listIterator = (VariableInfo *)listIterator->nestSymbolInfo;
-            }
-        }
-        return false;
+        return variables[index];
+    }
+    unsigned long long getSignatureHash()
+    {
+        return signatureHash;
+    }
+    bool findVariable(string_view variableName, unsigned long long variableNameHash)
+    {
+        return names.count({variableName, variableNameHash}) > 0;
+    }
+    bool findVariable(string_view variableName)
+    {
+        return findVariable(variableName, hashSymbolName(variableName));
     }
     bool isEqualTo(VariableList *parameterList)
     {
@@ -173,23 +280,16 @@ public:
         {
             return false;
         }
-        if (size != parameterList->getSize())
+        if (getSize() != parameterList->getSize() || signatureHash != parameterList->getSignatureHash())
         {
             return false;
         }
-        VariableInfo *listIterator = list;
-        VariableInfo *parameterListIterator = parameterList->list;
-        while (listIterator != nullptr && parameterListIterator != nullptr)
+        for (int i = 0; i < getSize(); i++)
         {
-            if (listIterator->getTypeSpecifier() != parameterListIterator->getTypeSpecifier())
+            if (variables[i]->getTypeSpecifier() != parameterList->getVariable(i)->getTypeSpecifier())
             {
                 return false;
             }
-            else
-            {
-                listIterator = (VariableInfo *)listIterator->nestSymbolInfo;
-                parameterListIterator = (VariableInfo *)parameterListIterator->nestSymbolInfo;
-            }
         }
         return true;
     }
@@ -199,13 +299,13 @@ class FunctionInfo : public VariableInfo
 {
 protected:
     bool defined = false;
-    string returnType;
+    const TypeDescriptor *returnType;
     VariableList *parameterList;
     int parameterCount;
     int funcStackOffset;
 
 public:
-    FunctionInfo(string name, string returnType, VariableList *parameterList = nullptr, string type = "FUNCTION") : VariableInfo(name, returnType, type)
+    FunctionInfo(string name, const TypeDescriptor *returnType, VariableList *parameterList = nullptr, SymbolKind kind = SymbolKind::FUNCTION) : VariableInfo(name, returnType, kind)
     {
         this->returnType = returnType;
         this->parameterList = parameterList;
@@ -219,7 +319,7 @@ public:
     {
         defined = true;
     }
-    string getReturnType()
+    const TypeDescriptor *getReturnType()
     {
         return returnType;
     }
@@ -273,70 +373,49 @@ public:
     }
     virtual string toString()
     {
-        return "<" + name + "," + type + "," + returnType + ">";
+        return "<" + name + "," + getKindName() + "," + returnType->name + ">";
     }
 };
 
 class ScopeTable
 {
 private:
-    string id;
+    int id;
     unsigned long long nextChildSerial;
     unsigned long long totalBuckets;
     SymbolInfo **scopeHashTable;
+    // A scope keeps its first few symbols in a small inline array, searched
+    // linearly, and only allocates its totalBuckets chains once it outgrows
+    // it. Most block scopes declare nothing and never allocate at all.
+    static const int inlineCapacity = 4;
+    SymbolInfo *inlineSymbols[inlineCapacity];
+    int inlineCount;
 
-    unsigned long long Hash(string str)
-    {
-        unsigned long long hash = 0;
-        unsigned long long i = 0;
-        unsigned long long len = str.length();
-
-        for (i = 0; i < len; i++)
-        {
-            hash = (str[i]) + (hash << 6) + (hash << 16) - hash;
-        }
-        return hash;
-    }
-    unsigned long long getChainIndex(string SymbolName)
+    unsigned long long getChainIndex(unsigned long long nameHash)
     {
-        return Hash(SymbolName) % totalBuckets;
+        return nameHash % totalBuckets;
     }
-
-public:
-    ScopeTable *parentScope;
-    ScopeTable(string id, unsigned long long totalBuckets, ScopeTable *parentScope = nullptr)
+    // Moves the inline symbols into freshly allocated chains, in insertion
+    // order, so the chains end up as if the table had been hashed all along
+    void spillToHashTable()
     {
-        this->id = id;
-        this->totalBuckets = totalBuckets;
-        this->parentScope = parentScope;
-        this->scopeHashTable = new SymbolInfo *[totalBuckets];
+        scopeHashTable = new SymbolInfo *[totalBuckets];
         for (int i = 0; i < totalBuckets; i++)
         {
             scopeHashTable[i] = nullptr;
         }
-        this->nextChildSerial = 1;
-    }
-    ~ScopeTable()
-    {
-        parentScope = nullptr;
-        for (int i = 0; i < totalBuckets; i++)
+        for (int i = 0; i < inlineCount; i++)
         {
-            SymbolInfo *chainRoot = scopeHashTable[i];
-            scopeHashTable[i] = nullptr;
-            while (chainRoot != nullptr)
-            {
-                SymbolInfo *toBeDeleted = chainRoot;
-                chainRoot = chainRoot->nestSymbolInfo;
-                delete toBeDeleted;
-            }
+            inlineSymbols[i]->nestSymbolInfo = nullptr;
+            insertIntoChain(inlineSymbols[i]);
         }
-        delete[] scopeHashTable;
+        inlineCount = 0;
     }
-    bool Insert(SymbolInfo *symbolInfo)
+    bool insertIntoChain(SymbolInfo *symbolInfo)
     {
         bool successfulInsertion;
         unsigned long long symbolInfoIndex = -1;
-        unsigned long long chainIndex = getChainIndex(symbolInfo->getName());
+        unsigned long long chainIndex = getChainIndex(symbolInfo->getNameHash());
 
         if (scopeHashTable[chainIndex] == nullptr)
         {
@@ -348,7 +427,7 @@ public:
         {
             symbolInfoIndex++;
             SymbolInfo *chainIterator = scopeHashTable[chainIndex];
-            if (chainIterator->getName() == symbolInfo->getName())
+            if (chainIterator->isNamed(symbolInfo->getName(), symbolInfo->getNameHash()))
             {
                 successfulInsertion = false;
             }
@@ -357,7 +436,7 @@ public:
                 symbolInfoIndex++;
                 while (chainIterator->nestSymbolInfo != nullptr)
                 {
-                    if (chainIterator->nestSymbolInfo->getName() == symbolInfo->getName())
+                    if (chainIterator->nestSymbolInfo->isNamed(symbolInfo->getName(), symbolInfo->getNameHash()))
                     {
                         successfulInsertion = false;
                         break;
@@ -382,15 +461,79 @@ public:
             return false;
         }
     }
-    SymbolInfo *LookUp(string symbolName)
+
+public:
+    ScopeTable *parentScope;
+    ScopeTable(int id, unsigned long long totalBuckets, ScopeTable *parentScope = nullptr)
+    {
+        this->id = id;
+        this->totalBuckets = totalBuckets;
+        this->parentScope = parentScope;
+        this->scopeHashTable = nullptr;
+        this->inlineCount = 0;
+        this->nextChildSerial = 1;
+    }
+    ~ScopeTable()
     {
+        parentScope = nullptr;
+        for (int i = 0; i < inlineCount; i++)
+        {
+            delete inlineSymbols[i];
+        }
+        if (scopeHashTable == nullptr)
+        {
+            return;
+        }
+        for (int i = 0; i < totalBuckets; i++)
+        {
+            SymbolInfo *chainRoot = scopeHashTable[i];
+            scopeHashTable[i] = nullptr;
+            while (chainRoot != nullptr)
+            {
+                SymbolInfo *toBeDeleted = chainRoot;
+                chainRoot = chainRoot->nestSymbolInfo;
+                delete toBeDeleted;
+            }
+        }
+        delete[] scopeHashTable;
+    }
+    bool Insert(SymbolInfo *symbolInfo)
+    {
+        if (scopeHashTable == nullptr)
+        {
+            if (LookUp(symbolInfo->getName(), symbolInfo->getNameHash()) != nullptr)
+            {
+                return false;
+            }
+            if (inlineCount < inlineCapacity)
+            {
+                inlineSymbols[inlineCount++] = symbolInfo;
+                return true;
+            }
+            spillToHashTable();
+        }
+        return insertIntoChain(symbolInfo);
+    }
+    SymbolInfo *LookUp(string_view symbolName, unsigned long long nameHash)
+    {
+        if (scopeHashTable == nullptr)
+        {
+            for (int i = 0; i < inlineCount; i++)
+            {
+                if (inlineSymbols[i]->isNamed(symbolName, nameHash))
+                {
+                    return inlineSymbols[i];
+                }
+            }
+            return nullptr;
+        }
         unsigned long long symbolInfoIndex = -1;
-        unsigned long long chainIndex = getChainIndex(symbolName);
+        unsigned long long chainIndex = getChainIndex(nameHash);
         SymbolInfo *chainIterator = scopeHashTable[chainIndex];
         while (chainIterator != nullptr)
         {
             symbolInfoIndex++;
-            if (chainIterator->getName() == symbolName){
+            if (chainIterator->isNamed(symbolName, nameHash)){
                 return chainIterator;
             } else {
                 chainIterator = chainIterator->nestSymbolInfo;
@@ -398,15 +541,36 @@ public:
         }
         return chainIterator;
     }
-    bool Delete(string &symbolName)
+    SymbolInfo *LookUp(string_view symbolName)
     {
+        return LookUp(symbolName, hashSymbolName(symbolName));
+    }
+    bool Delete(string_view symbolName, unsigned long long nameHash)
+    {
+        if (scopeHashTable == nullptr)
+        {
+            for (int i = 0; i < inlineCount; i++)
+            {
+                if (inlineSymbols[i]->isNamed(symbolName, nameHash))
+                {
+                    delete inlineSymbols[i];
+                    for (int j = i + 1; j < inlineCount; j++)
+                    {
+                        inlineSymbols[j - 1] = inlineSymbols[j];
+                    }
+                    inlineCount--;
+                    return true;
+                }
+            }
+            return false;
+        }
         bool successfulDeletion = false;
         unsigned long long symbolInfoIndex = -1;
-        unsigned long long chainIndex = getChainIndex(symbolName);
+        unsigned long long chainIndex = getChainIndex(nameHash);
 
         if (scopeHashTable[chainIndex] != nullptr)
         {
-            if (scopeHashTable[chainIndex]->getName() == symbolName)
+            if (scopeHashTable[chainIndex]->isNamed(symbolName, nameHash))
             {
                 symbolInfoIndex++;
                 SymbolInfo *toBeDeleted = scopeHashTable[chainIndex];
@@ -421,7 +585,7 @@ public:
                 while (chainIterator->nestSymbolInfo != nullptr)
                 {
                     symbolInfoIndex++;
-                    if (chainIterator->nestSymbolInfo->getName() == symbolName)
+                    if (chainIterator->nestSymbolInfo->isNamed(symbolName, nameHash))
                     {
                         SymbolInfo *toBeDeleted = chainIterator->nestSymbolInfo;
                         SymbolInfo *toBeLinked = toBeDeleted->nestSymbolInfo;
@@ -449,12 +613,35 @@ public:
     }
     SymbolInfo **getHashTable()
     {
+        if (scopeHashTable == nullptr)
+        {
+            spillToHashTable();
+        }
         return scopeHashTable;
     }
     string toString()
     {
         string scopeTable = "";
-        scopeTable += "\tScopeTable# " + id + "\n";
+        scopeTable += "\tScopeTable# " + to_string(id) + "\n";
+        if (scopeHashTable == nullptr)
+        {
+            for (int i = 0; i < totalBuckets; i++)
+            {
+                string chain = "";
+                for (int j = 0; j < inlineCount; j++)
+                {
+                    if (getChainIndex(inlineSymbols[j]->getNameHash()) == i)
+                    {
+                        chain += inlineSymbols[j]->toString() + " ";
+                    }
+                }
+                if (!chain.empty())
+                {
+                    scopeTable += "\t" + to_string(i + 1) + "--> " + chain + "\n";
+                }
+            }
+            return scopeTable;
+        }
         for (int i = 0; i < totalBuckets; i++)
         {
             SymbolInfo *toBePrinted = scopeHashTable[i];
@@ -471,7 +658,7 @@ public:
         }
         return scopeTable;
     }
-    string getId()
+    int getId()
     {
         return id;
     }
@@ -488,6 +675,35 @@ private:
     ScopeTable *scopeTableList;
     ScopeTable *currentScopeTable;
     unsigned long long totalBuckets;
+    // Scopes that have been exited but whose symbols may still be referenced
+    // by the AST of the unit being compiled
+    vector<ScopeTable *> retiredScopeTables;
+    // Each name maps to the stack of its visible bindings, innermost last,
+    // tagged with the depth of the scope that declared it, so a lookup is a
+    // single probe however deeply scopes are nested. Keys view the name of
+    // the outermost binding, which is the last one popped.
+    unordered_map<SymbolKey, vector<pair<int, SymbolInfo *>>, SymbolKeyHash> bindingStacks;
+    // Names declared in each open scope, outermost first; ExitScope pops
+    // exactly these bindings
+    vector<vector<SymbolKey>> scopeBindings;
+
+    void popBinding(SymbolKey symbolKey)
+    {
+        auto bindingStack = bindingStacks.find(symbolKey);
+        bindingStack->second.pop_back();
+        if (bindingStack->second.empty())
+        {
+            bindingStacks.erase(bindingStack);
+        }
+    }
+    void popScopeBindings()
+    {
+        for (SymbolKey &symbolKey : scopeBindings.back())
+        {
+            popBinding(symbolKey);
+        }
+        scopeBindings.pop_back();
+    }
 
 public:
     SymbolTable(unsigned long long totalBuckets)
@@ -495,10 +711,11 @@ public:
         this->latestScopeTableId = 1;
         this->scopeTableList = nullptr;
         this->totalBuckets = totalBuckets;
-        createNewScopeTable(to_string(latestScopeTableId));
+        createNewScopeTable(latestScopeTableId);
     }
     ~SymbolTable()
     {
+        deleteRetiredScopes();
         while (currentScopeTable != nullptr)
         {
             deleteCurrentScope();
@@ -507,46 +724,78 @@ public:
     void EnterScope()
     {
         latestScopeTableId++;
-        createNewScopeTable(to_string(latestScopeTableId));
+        createNewScopeTable(latestScopeTableId);
     }
     void ExitScope()
     {
         if (currentScopeTable->parentScope != nullptr)
         {
+            popScopeBindings();
+            retiredScopeTables.push_back(currentScopeTable);
             currentScopeTable = currentScopeTable->parentScope;
         }
     }
-    bool Insert(SymbolInfo *symbolInfo)
-    {
-        return currentScopeTable->Insert(symbolInfo);
-    }
-    bool Remove(string symbolName)
+    void deleteRetiredScopes()
     {
-        return currentScopeTable->Delete(symbolName);
+        for (ScopeTable *scopeTable : retiredScopeTables)
+        {
+            delete scopeTable;
+        }
+        retiredScopeTables.clear();
     }
-    SymbolInfo *LookUpCurrentScope(string symbolName)
+    bool Insert(SymbolInfo *symbolInfo)
     {
-        return currentScopeTable->LookUp(symbolName);
+        if (!currentScopeTable->Insert(symbolInfo))
+        {
+            return false;
+        }
+        SymbolKey symbolKey = {symbolInfo->getName(), symbolInfo->getNameHash()};
+        bindingStacks[symbolKey].push_back({(int)scopeBindings.size() - 1, symbolInfo});
+        scopeBindings.back().push_back(symbolKey);
+        return true;
     }
-    SymbolInfo *LookUp(string symbolName)
+    bool Remove(string_view symbolName)
     {
-        SymbolInfo *lookUpResult = nullptr;
-        ScopeTable *tmpScopeTable = currentScopeTable;
-        while (tmpScopeTable != nullptr)
+        SymbolKey symbolKey = {symbolName, hashSymbolName(symbolName)};
+        if (LookUpCurrentScope(symbolKey.name, symbolKey.hash) == nullptr)
         {
-            lookUpResult = tmpScopeTable->LookUp(symbolName);
-            if (lookUpResult)
-            {
-                return lookUpResult;
-            }
-            else
+            return false;
+        }
+        popBinding(symbolKey);
+        vector<SymbolKey> &currentBindings = scopeBindings.back();
+        for (int i = currentBindings.size() - 1; i >= 0; i--)
+        {
+            if (currentBindings[i] == symbolKey)
             {
-                tmpScopeTable = tmpScopeTable->parentScope;
+                currentBindings.erase(currentBindings.begin() + i);
+                break;
             }
         }
-        return lookUpResult;
+        return currentScopeTable->Delete(symbolKey.name, symbolKey.hash);
+    }
+    SymbolInfo *LookUpCurrentScope(string_view symbolName, unsigned long long nameHash)
+    {
+        auto bindingStack = bindingStacks.find({symbolName, nameHash});
+        if (bindingStack == bindingStacks.end() || bindingStack->second.back().first != (int)scopeBindings.size() - 1)
+        {
+            return nullptr;
+        }
+        return bindingStack->second.back().second;
+    }
+    SymbolInfo *LookUpCurrentScope(string_view symbolName)
+    {
+        return LookUpCurrentScope(symbolName, hashSymbolName(symbolName));
+    }
+    SymbolInfo *LookUp(string_view symbolName, unsigned long long nameHash)
+    {
+        auto bindingStack = bindingStacks.find({symbolName, nameHash});
+        return bindingStack == bindingStacks.end() ? nullptr : bindingStack->second.back().second;
+    }
+    SymbolInfo *LookUp(string_view symbolName)
+    {
+        return LookUp(symbolName, hashSymbolName(symbolName));
     }
-    void createNewScopeTable(string newScopeTableId)
+    void createNewScopeTable(int newScopeTableId)
     {
         if (scopeTableList == nullptr)
         {
@@ -558,11 +807,13 @@ public:
             ScopeTable *tmpScopeTabe = new ScopeTable(newScopeTableId, totalBuckets, currentScopeTable);
             currentScopeTable = tmpScopeTabe;
         }
+        scopeBindings.push_back(vector<SymbolKey>());
     }
     void deleteCurrentScope()
     {
         ScopeTable *temp = currentScopeTable;
         currentScopeTable = currentScopeTable->parentScope;
+        popScopeBindings();
         delete temp;
     }
     string PrintCurrentScopeTable()
@@ -580,7 +831,7 @@ public:
         }
         return str;
     }
-    string getCurrentScopeTableId()
+    int getCurrentScopeTableId()
     {
         return currentScopeTable->getId();
     }
@@ -0,0 +1,275 @@
+#pragma once
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "lex_utils.h"
+
+using namespace std;
+
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void *yyscan_t;
+#endif
+
+class LexerState
+{
+public:
+    string token_buf;
+    bool hasManyDeciamal;
+    ostream *logStream;
+    int totalLines;
+    int totalErrors;
+
+    LexerState(ostream *logStream = nullptr)
+    {
+        this->hasManyDeciamal = false;
+        this->logStream = logStream;
+        this->totalLines = 0;
+        this->totalErrors = 0;
+    }
+};
+
+class Token
+{
+public:
+    int kind;
+    int lineNo;
+    SymbolInfo *symbolInfo;
+    size_t logEnd;
+    int errorCount;
+
+    Token(int kind = 0, int lineNo = 0, SymbolInfo *symbolInfo = nullptr, size_t logEnd = 0, int errorCount = 0)
+    {
+        this->kind = kind;
+        this->lineNo = lineNo;
+        this->symbolInfo = symbolInfo;
+        this->logEnd = logEnd;
+        this->errorCount = errorCount;
+    }
+};
+
+// A run of tokens scanned together: a slice of the source in parallel mode, a
+// batch of the token stream in pipeline mode. The last token is always an end
+// marker. Every token remembers how much of the chunk's log and error count it
+// accounts for, so handing the tokens to the parser in order replays the log
+// exactly as a serial scan would have written it.
+class TokenChunk
+{
+public:
+    const char *source;
+    size_t length;
+    int firstLine;
+    vector<Token> tokens;
+    string log;
+    int totalLines;
+    // Scanner state left at the end of the chunk
+    int endState;
+    string tokenBuf;
+    bool hasManyDeciamal;
+
+    TokenChunk(const char *source, size_t length, int firstLine)
+    {
+        this->source = source;
+        this->length = length;
+        this->firstLine = firstLine;
+        this->totalLines = 0;
+        this->endState = 0;
+        this->hasManyDeciamal = false;
+    }
+};
+
+// Splits the source into at most chunkCount pieces. Each piece starts right
+// after a '\n' that is not inside a comment, which is the only place where the
+// scanner is guaranteed to be back in INITIAL with nothing buffered.
+inline vector<TokenChunk *> splitIntoChunks(const char *source, size_t length, int chunkCount)
+{
+    vector<TokenChunk *> chunks;
+    size_t chunkStart = 0;
+    int chunkFirstLine = 1;
+    int lineNo = 1;
+    bool inLineComment = false;
+    bool inBlockComment = false;
+    size_t i = 0;
+    while (i < length)
+    {
+        char c = source[i];
+        if (inBlockComment)
+        {
+            if (c == '*' && i + 1 < length && source[i + 1] == '/')
+            {
+                inBlockComment = false;
+                i++;
+            }
+        }
+        else if (inLineComment)
+        {
+            if (c == '\\' && i + 1 < length && (source[i + 1] == '\n' || source[i + 1] == '\r'))
+            {
+                i++;
+                if (source[i] == '\r' && i + 1 < length && source[i + 1] == '\n')
+                {
+                    i++;
+                }
+                if (source[i] == '\n')
+                {
+                    lineNo++;
+                }
+                i++;
+                continue;
+            }
+            if (c == '\n')
+            {
+                inLineComment = false;
+            }
+        }
+        else if (c == '/' && i + 1 < length && source[i + 1] == '/')
+        {
+            inLineComment = true;
+            i++;
+        }
+        else if (c == '/' && i + 1 < length && source[i + 1] == '*')
+        {
+            inBlockComment = true;
+            i++;
+        }
+
+        if (source[i] == '\n')
+        {
+            lineNo++;
+            size_t target = chunkStart + (length - chunkStart) / (chunkCount - chunks.size());
+            if (!inBlockComment && !inLineComment && i + 1 >= target && i + 1 < length && (int)chunks.size() < chunkCount - 1)
+            {
+                chunks.push_back(new TokenChunk(source + chunkStart, i + 1 - chunkStart, chunkFirstLine));
+                chunkStart = i + 1;
+                chunkFirstLine = lineNo;
+            }
+        }
+        i++;
+    }
+    chunks.push_back(new TokenChunk(source + chunkStart, length - chunkStart, chunkFirstLine));
+    return chunks;
+}
+
+// Single-producer/single-consumer ring of token batches. Tokens cross threads a
+// whole batch at a time, and the two indices sit on separate cache lines, so the
+// scanner and the parser touch shared lines only once per batch.
+class TokenChunkRing
+{
+private:
+    static const size_t capacity = 64;
+    TokenChunk *slots[capacity];
+    alignas(64) atomic<size_t> head;
+    alignas(64) atomic<size_t> tail;
+
+public:
+    TokenChunkRing()
+    {
+        head.store(0);
+        tail.store(0);
+    }
+    void push(TokenChunk *chunk)
+    {
+        size_t currentTail = tail.load(memory_order_relaxed);
+        while (currentTail - head.load(memory_order_acquire) == capacity)
+        {
+            this_thread::yield();
+        }
+        slots[currentTail % capacity] = chunk;
+        tail.store(currentTail + 1, memory_order_release);
+    }
+    TokenChunk *pop()
+    {
+        size_t currentHead = head.load(memory_order_relaxed);
+        while (tail.load(memory_order_acquire) == currentHead)
+        {
+            this_thread::yield();
+        }
+        TokenChunk *chunk = slots[currentHead % capacity];
+        head.store(currentHead + 1, memory_order_release);
+        return chunk;
+    }
+};
+
+// Hands pre-scanned tokens to the parser one at a time, in source order.
+class TokenStream
+{
+private:
+    TokenChunk *currentChunk;
+    size_t tokenIndex;
+    size_t logOffset;
+    int chunkErrors;
+    ostream *logStream;
+    int totalLines;
+    int totalErrors;
+
+protected:
+    // Returns the next chunk in source order, or nullptr after the last one.
+    virtual TokenChunk *fetchChunk() = 0;
+
+public:
+    TokenStream(ostream *logStream)
+    {
+        this->currentChunk = nullptr;
+        this->tokenIndex = 0;
+        this->logOffset = 0;
+        this->chunkErrors = 0;
+        this->logStream = logStream;
+        this->totalLines = 0;
+        this->totalErrors = 0;
+    }
+    virtual ~TokenStream()
+    {
+        delete currentChunk;
+    }
+    Token next()
+    {
+        while (true)
+        {
+            if (currentChunk == nullptr)
+            {
+                currentChunk = fetchChunk();
+                tokenIndex = 0;
+                logOffset = 0;
+                chunkErrors = 0;
+            }
+            if (tokenIndex == currentChunk->tokens.size())
+            {
+                return currentChunk->tokens.back();
+            }
+            Token token = currentChunk->tokens[tokenIndex++];
+            logStream->write(currentChunk->log.data() + logOffset, token.logEnd - logOffset);
+            logOffset = token.logEnd;
+            totalErrors += token.errorCount - chunkErrors;
+            chunkErrors = token.errorCount;
+
+            if (tokenIndex == currentChunk->tokens.size())
+            {
+                TokenChunk *nextChunk = fetchChunk();
+                if (nextChunk == nullptr)
+                {
+                    totalLines = currentChunk->totalLines;
+                    return token;
+                }
+                logStream->write(currentChunk->log.data() + logOffset, currentChunk->log.size() - logOffset);
+                delete currentChunk;
+                currentChunk = nextChunk;
+                tokenIndex = 0;
+                logOffset = 0;
+                chunkErrors = 0;
+                continue;
+            }
+            return token;
+        }
+    }
+    int getTotalLines()
+    {
+        return totalLines;
+    }
+    int getTotalErrors()
+    {
+        return totalErrors;
+    }
+};
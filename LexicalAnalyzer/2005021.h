@@ -1,4 +1,5 @@
 #include <iostream>
+#include "../SymbolTable/2005021_HashPolicy.h"
 
 using namespace std;
 
@@ -29,52 +30,41 @@ public:
     }
 };
 
-class ScopeTable
+template <typename HashPolicy>
+class BasicScopeTable
 {
 private:
     string id;
     unsigned long long nextChildSerial;
     unsigned long long totalBuckets;
     SymbolInfo **scopeHashTable;
-
-    unsigned long long Hash(string str)
-    {
-        unsigned long long hash = 0;
-        unsigned long long i = 0;
-        unsigned long long len = str.length();
-
-        for (i = 0; i < len; i++)
-        {
-            hash = (str[i]) + (hash << 6) + (hash << 16) - hash;
-        }
-        return hash;
-    }
+    HashPolicy hashPolicy;
 
     unsigned long long getChainIndex(string &SymbolName)
     {
-        return Hash(SymbolName) % totalBuckets;
+        return hashPolicy(SymbolName) % totalBuckets;
     }
 
 public:
-    ScopeTable *parentScope;
+    BasicScopeTable *parentScope;
 
-    ScopeTable(string id, unsigned long long totalBuckets, ScopeTable *parentScope = nullptr)
+    BasicScopeTable(string id, unsigned long long totalBuckets, BasicScopeTable *parentScope = nullptr)
     {
         this->id = id;
         this->totalBuckets = totalBuckets;
         this->parentScope = parentScope;
         this->scopeHashTable = new SymbolInfo *[totalBuckets];
-        for (int i = 0; i < totalBuckets; i++)
+        for (unsigned long long i = 0; i < totalBuckets; i++)
         {
             scopeHashTable[i] = nullptr;
         }
         this->nextChildSerial = 1;
     }
 
-    ~ScopeTable()
+    ~BasicScopeTable()
     {
         parentScope = nullptr;
-        for (int i = 0; i < totalBuckets; i++)
+        for (unsigned long long i = 0; i < totalBuckets; i++)
         {
             SymbolInfo *chainRoot = scopeHashTable[i];
             scopeHashTable[i] = nullptr;
@@ -215,7 +205,7 @@ public:
     {
         string scopeTable = "";
         scopeTable += "\tScopeTable# " + id + "\n";
-        for (int i = 0; i < totalBuckets; i++)
+        for (unsigned long long i = 0; i < totalBuckets; i++)
         {
             scopeTable += "\t" + to_string(i + 1);
             SymbolInfo *toBePrinted = scopeHashTable[i];
@@ -240,9 +230,12 @@ public:
     }
 };
 
-class SymbolTable
+template <typename HashPolicy>
+class BasicSymbolTable
 {
 private:
+    typedef BasicScopeTable<HashPolicy> ScopeTable;
+
     ScopeTable *scopeTableList;
     ScopeTable *currentScopeTable;
     unsigned long long totalBuckets;
@@ -269,7 +262,7 @@ private:
     }
 
 public:
-    SymbolTable(unsigned long long totalBuckets)
+    BasicSymbolTable(unsigned long long totalBuckets)
     {
         this->scopeTableList = nullptr;
         this->totalBuckets = totalBuckets;
@@ -277,7 +270,7 @@ public:
         createNewScopeTable(mainScopeTableId);
     }
 
-    ~SymbolTable()
+    ~BasicSymbolTable()
     {
         while (currentScopeTable != nullptr)
         {
@@ -344,4 +337,7 @@ public:
         }
 		return allScopeTable;
     }
-};
\ No newline at end of file
+};
+
+typedef BasicScopeTable<SdbmHash> ScopeTable;
+typedef BasicSymbolTable<SdbmHash> SymbolTable;
@@ -0,0 +1,140 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "2005021_SymbolTable.h"
+
+// Fills one ScopeTable per hash policy with each identifier set and reports how
+// the chains came out and how fast successful lookups run over them.
+//
+//     g++ -O2 2005021_HashBenchmark.cpp -o hash_benchmark
+//     ./hash_benchmark [bucketCount ...]
+
+const unsigned long long lookUpBudget = 200000;
+
+vector<string> realisticNames(){
+    string bases[] = {"i", "j", "k", "n", "m", "x", "y", "z", "a", "b", "c", "sum", "count", "temp", "result",
+                      "index", "arr", "ptr", "len", "flag", "max", "min", "total", "value", "node", "next", "prev",
+                      "head", "tail", "left", "right", "key", "data", "size", "buf", "str", "ch", "mid", "low",
+                      "high", "first", "last", "ans", "res", "val", "num", "cnt", "pos", "idx", "tmp"};
+    string suffixes[] = {"", "1", "2", "3", "Count", "Index", "Ptr", "Max"};
+    vector<string> names;
+    for (string &base : bases){
+        for (string &suffix : suffixes){
+            names.push_back(base + suffix);
+        }
+    }
+    return names;
+}
+
+vector<string> generatedNames(){
+    vector<string> names;
+    for (int i = 1; i <= 9999; i++){
+        string digits = to_string(i);
+        names.push_back("tmp" + string(4 - digits.length(), '0') + digits);
+    }
+    return names;
+}
+
+// Names that all land in chain 0 under sdbm for this bucket count, the way a
+// hostile input would pile them onto one chain
+vector<string> adversarialNames(unsigned long long totalBuckets, unsigned long long wanted){
+    vector<string> names;
+    SdbmHash sdbm;
+    for (int length = 2; names.size() < wanted; length++){
+        string name(length, 'a');
+        name[0] = 'v';
+        while (names.size() < wanted){
+            if (sdbm(name) % totalBuckets == 0){
+                names.push_back(name);
+            }
+            int position = length - 1;
+            while (position > 0 && name[position] == 'z'){
+                name[position--] = 'a';
+            }
+            if (position == 0){
+                break;
+            }
+            name[position]++;
+        }
+    }
+    return names;
+}
+
+template <typename HashPolicy>
+void runPolicy(ostream &report, string policyName, string setName, vector<string> &names, unsigned long long totalBuckets){
+    BasicScopeTable<HashPolicy> scopeTable(1, totalBuckets);
+    for (string &name : names){
+        scopeTable.Insert(name, "ID");
+    }
+
+    unsigned long long emptyChains = 0;
+    unsigned long long maxChain = 0;
+    double probeSum = 0;
+    double squareSum = 0;
+    for (unsigned long long i = 0; i < totalBuckets; i++){
+        unsigned long long chainLength = scopeTable.getChainLength(i);
+        if (chainLength == 0){
+            emptyChains++;
+        }
+        if (chainLength > maxChain){
+            maxChain = chainLength;
+        }
+        probeSum += chainLength * (chainLength + 1) / 2.0;
+        squareSum += (double)chainLength * chainLength;
+    }
+    double meanChain = (double)names.size() / totalBuckets;
+    double chainDeviation = sqrt(squareSum / totalBuckets - meanChain * meanChain);
+
+    unsigned long long rounds = lookUpBudget / names.size() + 1;
+    unsigned long long found = 0;
+    unsigned long long chainIndex;
+    unsigned long long symbolInfoIndex;
+    auto start = chrono::steady_clock::now();
+    for (unsigned long long round = 0; round < rounds; round++){
+        for (string &name : names){
+            if (scopeTable.Find(name, chainIndex, symbolInfoIndex) != nullptr){
+                found++;
+            }
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    report << left << setw(13) << setName << setw(8) << policyName << right
+           << setw(8) << names.size() << setw(8) << emptyChains << setw(8) << maxChain
+           << setw(10) << fixed << setprecision(2) << chainDeviation
+           << setw(10) << probeSum / names.size()
+           << setw(14) << setprecision(0) << found / seconds << endl;
+}
+
+void runSet(ostream &report, string setName, vector<string> names, unsigned long long totalBuckets){
+    runPolicy<SdbmHash>(report, "sdbm", setName, names, totalBuckets);
+    runPolicy<Fnv1aHash>(report, "fnv1a", setName, names, totalBuckets);
+    runPolicy<MixHash>(report, "mix", setName, names, totalBuckets);
+}
+
+int main(int argc, char *argv[]){
+    vector<unsigned long long> bucketCounts;
+    for (int i = 1; i < argc; i++){
+        bucketCounts.push_back(stoull(argv[i]));
+    }
+    if (bucketCounts.empty()){
+        bucketCounts.push_back(11);
+        bucketCounts.push_back(1009);
+    }
+
+    ostream &report = cout;
+
+    for (unsigned long long totalBuckets : bucketCounts){
+        report << "buckets = " << totalBuckets << endl;
+        report << left << setw(13) << "set" << setw(8) << "policy" << right
+               << setw(8) << "names" << setw(8) << "empty" << setw(8) << "longest"
+               << setw(10) << "stddev" << setw(10) << "probes" << setw(14) << "lookups/s" << endl;
+        runSet(report, "realistic", realisticNames(), totalBuckets);
+        runSet(report, "generated", generatedNames(), totalBuckets);
+        runSet(report, "adversarial", adversarialNames(totalBuckets, 500), totalBuckets);
+        report << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include<string_view>
+
+using namespace std;
+
+// Hash policies for ScopeTable. A policy is any functor that maps a symbol
+// name to an unsigned 64-bit hash; ScopeTable calls it directly, so picking
+// one is a compile-time choice with no dispatch on the lookup path. The
+// lexical and syntax analyzers include this header from here.
+struct SdbmHash{
+    unsigned long long operator()(string_view str) const{
+        unsigned long long hash = 0;
+        unsigned long long len = str.length();
+
+        for (unsigned long long i = 0; i < len; i++){
+            hash = (str[i]) + (hash << 6) + (hash << 16) - hash;
+        }
+        return hash;
+    }
+};
+
+struct Fnv1aHash{
+    unsigned long long operator()(string_view str) const{
+        unsigned long long hash = 14695981039346656037ULL;
+        unsigned long long len = str.length();
+
+        for (unsigned long long i = 0; i < len; i++){
+            hash ^= (unsigned char)str[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+};
+
+// wyhash-style mixer: eight bytes at a time, each folded in with a 64x64->128
+// bit multiply whose halves are xored together
+struct MixHash{
+    static unsigned long long mix(unsigned long long a, unsigned long long b){
+#ifdef __SIZEOF_INT128__
+        __uint128_t product = (__uint128_t)a * b;
+        return (unsigned long long)product ^ (unsigned long long)(product >> 64);
+#else
+        // no 128-bit integers: build the product from 32-bit halves
+        unsigned long long aLow = a & 0xffffffffULL, aHigh = a >> 32;
+        unsigned long long bLow = b & 0xffffffffULL, bHigh = b >> 32;
+        unsigned long long lowLow = aLow * bLow, lowHigh = aLow * bHigh;
+        unsigned long long highLow = aHigh * bLow, highHigh = aHigh * bHigh;
+        unsigned long long cross = (lowLow >> 32) + (highLow & 0xffffffffULL) + lowHigh;
+        unsigned long long upper = (highLow >> 32) + (cross >> 32) + highHigh;
+        unsigned long long lower = (cross << 32) | (lowLow & 0xffffffffULL);
+        return lower ^ upper;
+#endif
+    }
+
+    unsigned long long operator()(string_view str) const{
+        unsigned long long len = str.length();
+        unsigned long long hash = 0xa0761d6478bd642fULL ^ len;
+
+        for (unsigned long long i = 0; i < len; i += 8){
+            unsigned long long word = 0;
+            for (unsigned long long b = 0; b < 8 && i + b < len; b++){
+                word |= (unsigned long long)(unsigned char)str[i + b] << (8 * b);
+            }
+            hash = mix(hash ^ word, 0xe7037ed1a0b428dbULL);
+        }
+        return mix(hash, 0x8ebc6af09c88c6e3ULL);
+    }
+};
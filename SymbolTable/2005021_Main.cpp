@@ -1,102 +1,194 @@
-#include <iostream>
-#include "2005021_SymbolTable.h"
-
-string removeSpaces(const string &str) {
-    string result;
-    for (char c : str) {
-        if (!isspace(c)) {
-            result += c;
-        }
-    }
-    return result;
-}
-
-int splitString(string line, string delimiter, string args[]){
-    int count = 0;
-    int end = line.find(delimiter); 
-    while (end != -1) {
-        args[count++] = removeSpaces(line.substr(0, end));
-        line.erase(line.begin(), line.begin() + end + 1);
-        end = line.find(delimiter);
-    }
-    args[count++] = removeSpaces(line.substr(0, line.length()));
-    return count;
-}
-
-int main(){
-    SymbolTable *symbolTable;
-
-    freopen("input.txt", "r", stdin);
-    freopen("output.txt", "w", stdout);
-    
-    string bucketCount;
-    getline(cin, bucketCount);
-
-    symbolTable = new SymbolTable(stoull(bucketCount));
-
-    int cmd_no = 0;
-    while(!feof(stdin)){
-        cmd_no++;
-        string line, argv[10];
-        getline(cin, line);
-        if(line != "\0"){
-            int argc = splitString(line, " ", argv);
-
-            cout << "Cmd " + to_string(cmd_no) + ": " << line << endl;
-
-            if(argv[0] == "I"){
-                if(argc != 3){
-                    cout << "\tWrong number of arugments for the command I" << endl; 
-                }else{
-                    symbolTable->Insert(argv[1], argv[2]);
-                }
-            }else if(argv[0] == "L"){
-                if(argc != 2){
-                    cout << "\tWrong number of arugments for the command L" << endl; 
-                }else{
-                    symbolTable->LookUp(argv[1]);
-                }
-            }else if(argv[0] == "D"){
-                if(argc != 2){
-                    cout << "\tWrong number of arugments for the command D" << endl; 
-                }else{
-                    symbolTable->Remove(argv[1]);
-                }
-            }else if(argv[0] == "P"){
-                if(argc != 2){
-                    cout << "\tWrong number of arugments for the command P" << endl; 
-                }else{
-                    if(argv[1] == "A"){
-                        symbolTable->PrintAllScopeTable();
-                    }else if(argv[1] == "C"){
-                        symbolTable->PrintCurrentScopeTable();
-                    }else{
-                        cout << "\tInvalid argument for the command P" << endl;
-                    }
-                }
-            }else if(argv[0] == "S"){
-                if(argc != 1){
-                    cout << "\tWrong number of arugments for the command S" << endl; 
-                }else{
-                    symbolTable->EnterScope();
-                }
-            }else if(argv[0] == "E"){
-                if(argc != 1){
-                    cout << "\tWrong number of arugments for the command E" << endl; 
-                }else{
-                    symbolTable->ExitScope();
-                }
-            }else if(argv[0] == "Q"){
-                if(argc != 1){
-                    cout << "Wrong number of arugments for the command Q" << endl; 
-                }else{
-                    delete symbolTable;
-                }
-            }
-        }
-    }
-    fclose(stdin);
-    fclose(stdout);
-    
-    return 0;
-}
\ No newline at end of file
+#include <iostream>
+#include <algorithm>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "2005021_SymbolTable.h"
+
+const int maxArgs = 10;
+
+// Collects everything written to cout, the symbol table's reports included,
+// and hands it to the output file in large blocks instead of line by line
+class OutputBuffer : public streambuf{
+private:
+    static const size_t flushThreshold = 1 << 20;
+    FILE *output;
+    string buffer;
+
+    void writeBuffer(){
+        fwrite(buffer.data(), 1, buffer.size(), output);
+        buffer.clear();
+    }
+
+protected:
+    int overflow(int c) override{
+        if (c != EOF) {
+            buffer.push_back(c);
+            if (buffer.size() >= flushThreshold) {
+                writeBuffer();
+            }
+        }
+        return c;
+    }
+
+    streamsize xsputn(const char *str, streamsize count) override{
+        buffer.append(str, count);
+        if (buffer.size() >= flushThreshold) {
+            writeBuffer();
+        }
+        return count;
+    }
+
+    int sync() override{
+        writeBuffer();
+        return fflush(output);
+    }
+
+public:
+    OutputBuffer(FILE *output){
+        this->output = output;
+        buffer.reserve(flushThreshold + 4096);
+    }
+};
+
+// Maps the input privately, so commands can be tokenized in place without
+// the changes reaching the file
+char *mapInput(const char *fileName, size_t &size){
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) < 0 || fileStat.st_size == 0) {
+        close(fd);
+        return nullptr;
+    }
+    size = fileStat.st_size;
+    void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    return data == MAP_FAILED ? nullptr : (char *)data;
+}
+
+// Squeezes the whitespace out of a piece where it lies
+string_view removeSpaces(char *begin, char *end){
+    char *result = begin;
+    for (char *c = begin; c != end; c++) {
+        if (!isspace((unsigned char)*c)) {
+            *result++ = *c;
+        }
+    }
+    return string_view(begin, result - begin);
+}
+
+// Splits the line at every single space. All pieces are counted, but only the
+// first maxArgs are kept.
+int splitString(char *begin, char *end, string_view args[]){
+    int count = 0;
+    char *pieceBegin = begin;
+    for (char *c = begin; ; c++) {
+        if (c == end || *c == ' ') {
+            if (count < maxArgs) {
+                args[count] = removeSpaces(pieceBegin, c);
+            }
+            count++;
+            if (c == end) {
+                break;
+            }
+            pieceBegin = c + 1;
+        }
+    }
+    return count;
+}
+
+int main(){
+    SymbolTable *symbolTable;
+
+    size_t inputSize;
+    char *input = mapInput("input.txt", inputSize);
+    if (input == nullptr) {
+        cerr << "Cannot read input.txt" << endl;
+        return 1;
+    }
+    char *inputEnd = input + inputSize;
+
+    FILE *output = fopen("output.txt", "w");
+    OutputBuffer outputBuffer(output);
+    streambuf *consoleBuffer = cout.rdbuf(&outputBuffer);
+
+    char *lineBegin = input;
+    char *lineEnd = find(lineBegin, inputEnd, '\n');
+    TraceFormatter trace(cout);
+    symbolTable = new SymbolTable(stoull(string(lineBegin, lineEnd)), &trace);
+
+    int cmd_no = 0;
+    while(lineEnd != inputEnd){
+        cmd_no++;
+        lineBegin = lineEnd + 1;
+        lineEnd = find(lineBegin, inputEnd, '\n');
+        if(lineBegin != lineEnd){
+            cout << "Cmd " << cmd_no << ": " << string_view(lineBegin, lineEnd - lineBegin) << '\n';
+
+            string_view argv[maxArgs];
+            int argc = splitString(lineBegin, lineEnd, argv);
+
+            if(argv[0] == "I"){
+                if(argc != 3){
+                    cout << "\tWrong number of arugments for the command I\n";
+                }else{
+                    symbolTable->Insert(argv[1], argv[2]);
+                }
+            }else if(argv[0] == "L"){
+                if(argc != 2){
+                    cout << "\tWrong number of arugments for the command L\n";
+                }else{
+                    symbolTable->LookUp(argv[1]);
+                }
+            }else if(argv[0] == "D"){
+                if(argc != 2){
+                    cout << "\tWrong number of arugments for the command D\n";
+                }else{
+                    symbolTable->Remove(argv[1]);
+                }
+            }else if(argv[0] == "P"){
+                if(argc != 2){
+                    cout << "\tWrong number of arugments for the command P\n";
+                }else{
+                    if(argv[1] == "A"){
+                        symbolTable->PrintAllScopeTable();
+                    }else if(argv[1] == "C"){
+                        symbolTable->PrintCurrentScopeTable();
+                    }else{
+                        cout << "\tInvalid argument for the command P\n";
+                    }
+                }
+            }else if(argv[0] == "S"){
+                if(argc != 1){
+                    cout << "\tWrong number of arugments for the command S\n";
+                }else{
+                    symbolTable->EnterScope();
+                }
+            }else if(argv[0] == "E"){
+                if(argc != 1){
+                    cout << "\tWrong number of arugments for the command E\n";
+                }else{
+                    symbolTable->ExitScope();
+                }
+            }else if(argv[0] == "Q"){
+                if(argc != 1){
+                    cout << "Wrong number of arugments for the command Q\n";
+                }else{
+                    delete symbolTable;
+                }
+            }
+        }
+    }
+    munmap(input, inputSize);
+
+    cout.rdbuf(consoleBuffer);
+    outputBuffer.pubsync();
+    fclose(output);
+
+    return 0;
+}
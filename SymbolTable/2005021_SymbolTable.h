@@ -1,4 +1,7 @@
 #include<iostream>
+#include<string_view>
+#include<vector>
+#include "2005021_HashPolicy.h"
 
 using namespace std;
 
@@ -10,60 +13,174 @@ private:
 public:
     SymbolInfo *nestSymbolInfo;
 
-    SymbolInfo(string name, string type){
+    SymbolInfo(string_view name, string_view type){
         this->name = name;
         this->type = type;
         this->nestSymbolInfo = nullptr;
     }
 
-    string getName(){
+    const string &getName(){
         return name;
     }
 
-    string getType(){
+    const string &getType(){
         return type;
     }
 };
 
-class ScopeTable{
+// A scope's place in the scope tree: its serial among its parent's children,
+// its depth, and its parent's id. Entering a scope builds no string; the
+// dotted form such as 1.3.2 is only produced when an id is printed.
+// An id lives inside its ScopeTable, so it and every id below it dangle once
+// ExitScope deletes that table. Compare or print ids of open scopes only.
+struct ScopeId{
+    const ScopeId *parent;
+    unsigned long long serial;
+    unsigned long long depth;
+
+    bool operator==(const ScopeId &other) const{
+        if (this == &other){
+            return true;
+        }
+        if (depth != other.depth || serial != other.serial){
+            return false;
+        }
+        return parent == nullptr || *parent == *other.parent;
+    }
+
+    bool operator!=(const ScopeId &other) const{
+        return !(*this == other);
+    }
+};
+
+inline ostream &operator<<(ostream &out, const ScopeId &scopeId){
+    if (scopeId.parent != nullptr){
+        out << *scopeId.parent << '.';
+    }
+    return out << scopeId.serial;
+}
+
+// What an operation did. chainIndex and symbolInfoIndex are the zero-based
+// position the symbol was inserted at, found at, removed from, or already held
+// when an Insert is refused. scopeId names the scope the operation settled in;
+// it is null only for a SymbolTable::LookUp that found nothing.
+// Both pointers refer into the table: symbolInfo is valid until the symbol is
+// removed or its scope exited, and scopeId until that scope is exited. A
+// successful Remove returns no symbolInfo.
+struct SymbolTableResult{
+    bool success;
+    SymbolInfo *symbolInfo;
+    unsigned long long chainIndex;
+    unsigned long long symbolInfoIndex;
+    const ScopeId *scopeId;
+};
+
+// Receives every SymbolTable event. The table itself never formats anything;
+// a table built without an observer does no output at all.
+class SymbolTableObserver{
+public:
+    virtual ~SymbolTableObserver(){}
+    virtual void onInsert(string_view, const SymbolTableResult &){}
+    virtual void onLookUp(string_view, const SymbolTableResult &){}
+    virtual void onRemove(string_view, const SymbolTableResult &){}
+    virtual void onScopeCreated(const ScopeId &){}
+    virtual void onScopeDeleted(const ScopeId &){}
+    virtual void onExitRefused(const ScopeId &){}
+};
+
+// Writes the events as the text trace of output.txt. The dotted id of each
+// open scope is spelled once, when the scope is created, and kept by depth:
+// every scope a result names is on the open chain. A formatter follows a
+// single table.
+class TraceFormatter : public SymbolTableObserver{
 private:
-    string id;
-    unsigned long long nextChildSerial;
-    unsigned long long totalBuckets;
-    SymbolInfo **scopeHashTable;
+    ostream &out;
+    vector<string> openScopeIds;
+
+    const string &getText(const ScopeId &scopeId){
+        return openScopeIds[scopeId.depth - 1];
+    }
+
+public:
+    TraceFormatter(ostream &out) : out(out){}
 
-    unsigned long long Hash(string str){
-        unsigned long long hash = 0;
-        unsigned long long i = 0;
-        unsigned long long len = str.length();
+    void onInsert(string_view symbolName, const SymbolTableResult &result) override{
+        if (result.success){
+            out << "\tInserted  at position <" << (result.chainIndex + 1) << ", " << (result.symbolInfoIndex + 1) << "> of ScopeTable# " << getText(*result.scopeId) << '\n';
+        }else{
+            out << "\t'" << symbolName << "' already exists in the current ScopeTable# " << getText(*result.scopeId) << '\n';
+        }
+    }
 
-        for (i = 0; i < len; i++){
-            hash = (str[i]) + (hash << 6) + (hash << 16) - hash;
+    void onLookUp(string_view symbolName, const SymbolTableResult &result) override{
+        if (result.success){
+            out << "\t'" << symbolName << "' found at position <" << (result.chainIndex + 1) << ", " << (result.symbolInfoIndex + 1) << "> of ScopeTable# " << getText(*result.scopeId) << '\n';
+        }else{
+            out << "\t'" << symbolName << "' not found in any of the ScopeTables\n";
         }
-        return hash;
     }
 
-    unsigned long long getChainIndex(string &SymbolName){
-        return Hash(SymbolName) % totalBuckets;
+    void onRemove(string_view symbolName, const SymbolTableResult &result) override{
+        if (result.success){
+            out << "\tDeleted '" << symbolName << "' from position <" << (result.chainIndex + 1) << ", " << (result.symbolInfoIndex + 1) << "> of ScopeTable# " << getText(*result.scopeId) << '\n';
+        }else{
+            out << "\tNot found in the current ScopeTable# " << getText(*result.scopeId) << '\n';
+        }
+    }
+
+    void onScopeCreated(const ScopeId &scopeId) override{
+        openScopeIds.resize(scopeId.depth);
+        if (scopeId.parent == nullptr){
+            openScopeIds.back() = to_string(scopeId.serial);
+        }else{
+            openScopeIds.back() = getText(*scopeId.parent) + "." + to_string(scopeId.serial);
+        }
+        out << "\tScopeTable# " << openScopeIds.back() << " created\n";
+    }
+
+    void onScopeDeleted(const ScopeId &scopeId) override{
+        out << "\tScopeTable# " << getText(scopeId) << " deleted\n";
+    }
+
+    void onExitRefused(const ScopeId &scopeId) override{
+        out << "\tScopeTable# " << getText(scopeId) << " cannot be deleted\n";
+    }
+};
+
+template <typename HashPolicy>
+class BasicScopeTable{
+private:
+    ScopeId id;
+    unsigned long long nextChildSerial;
+    unsigned long long totalBuckets;
+    SymbolInfo **scopeHashTable;
+    HashPolicy hashPolicy;
+
+    unsigned long long getChainIndex(string_view SymbolName){
+        return hashPolicy(SymbolName) % totalBuckets;
     }
 
 public:
-    ScopeTable *parentScope;
+    BasicScopeTable *parentScope;
 
-    ScopeTable(string id, unsigned long long totalBuckets, ScopeTable *parentScope = nullptr){
-        this->id = id;
+    BasicScopeTable(unsigned long long serial, unsigned long long totalBuckets, BasicScopeTable *parentScope = nullptr){
+        if (parentScope == nullptr){
+            this->id = {nullptr, serial, 1};
+        }else{
+            this->id = {&parentScope->id, serial, parentScope->id.depth + 1};
+        }
         this->totalBuckets = totalBuckets;
         this->parentScope = parentScope;
         this->scopeHashTable = new SymbolInfo *[totalBuckets];
-        for(int i = 0; i < totalBuckets; i++){
+        for(unsigned long long i = 0; i < totalBuckets; i++){
             scopeHashTable[i] = nullptr;
         }
         this->nextChildSerial = 1;
     }
 
-    ~ScopeTable(){
+    ~BasicScopeTable(){
         parentScope = nullptr;
-        for(int i = 0; i < totalBuckets; i++){
+        for(unsigned long long i = 0; i < totalBuckets; i++){
             SymbolInfo *chainRoot = scopeHashTable[i];
             scopeHashTable[i] = nullptr;
             while(chainRoot != nullptr){
@@ -75,212 +192,212 @@ public:
         delete[] scopeHashTable;
     }
 
-    bool Insert(string symbolName, string symbolType){
-        bool successfulInsertion;
-        unsigned long long symbolInfoIndex = -1;
-        unsigned long long chainIndex = getChainIndex(symbolName);
-
-        if (scopeHashTable[chainIndex] == nullptr){
-            scopeHashTable[chainIndex] = new SymbolInfo(symbolName, symbolType);
-            symbolInfoIndex++;
-            successfulInsertion = true;
-        }else{
-            symbolInfoIndex++;
-            SymbolInfo *chainIterator = scopeHashTable[chainIndex];
-            if (chainIterator->getName() == symbolName){
-                successfulInsertion = false;
-            }else{
-                symbolInfoIndex++;
-                while (chainIterator->nestSymbolInfo != nullptr){
-                    if (chainIterator->nestSymbolInfo->getName() == symbolName){
-                        successfulInsertion = false;
-                        break;
-                    }else{
-                        symbolInfoIndex++;
-                        chainIterator = chainIterator->nestSymbolInfo;
-                    }
-                }
-                if (chainIterator->nestSymbolInfo == nullptr){
-                    successfulInsertion = true;
-                    chainIterator->nestSymbolInfo = new SymbolInfo(symbolName, symbolType);
-                }
+    SymbolTableResult Insert(string_view symbolName, string_view symbolType){
+        SymbolTableResult result = {false, nullptr, getChainIndex(symbolName), 0, &id};
+        SymbolInfo **link = &scopeHashTable[result.chainIndex];
+        while (*link != nullptr){
+            if ((*link)->getName() == symbolName){
+                result.symbolInfo = *link;
+                return result;
             }
+            link = &(*link)->nestSymbolInfo;
+            result.symbolInfoIndex++;
         }
-        
-        if (successfulInsertion == true){
-            cout << "\tInserted  at position <" + to_string(chainIndex + 1) + ", " + to_string(symbolInfoIndex + 1) + "> of ScopeTable# " + id << endl;
-            return true;
-        }else{
-            cout << "\t'" + symbolName + "'" + " already exists in the current ScopeTable# " + id << endl;
-            return false;
-        }
+        *link = new SymbolInfo(symbolName, symbolType);
+        result.success = true;
+        result.symbolInfo = *link;
+        return result;
     }
 
-    SymbolInfo *LookUp(string &symbolName){
-        unsigned long long symbolInfoIndex = -1;
-        unsigned long long chainIndex = getChainIndex(symbolName);
+    // Same walk as LookUp with the position in out-parameters, for callers that only need the symbol
+    SymbolInfo *Find(string_view symbolName, unsigned long long &chainIndex, unsigned long long &symbolInfoIndex){
+        symbolInfoIndex = 0;
+        chainIndex = getChainIndex(symbolName);
         SymbolInfo *chainIterator = scopeHashTable[chainIndex];
         while (chainIterator != nullptr){
-            symbolInfoIndex++;
             if (chainIterator->getName() == symbolName){
-                cout << "\t'" + symbolName + "'" + " found at position <" + to_string(chainIndex + 1) + ", " + to_string(symbolInfoIndex + 1) + "> of ScopeTable# " + id << endl;
                 return chainIterator;
-            }else{
-                chainIterator = chainIterator->nestSymbolInfo;
             }
+            chainIterator = chainIterator->nestSymbolInfo;
+            symbolInfoIndex++;
         }
         return chainIterator;
     }
 
-    bool Delete(string &symbolName){
-        bool successfulDeletion = false;
-        unsigned long long symbolInfoIndex = -1;
-        unsigned long long chainIndex = getChainIndex(symbolName);
+    SymbolTableResult LookUp(string_view symbolName){
+        SymbolTableResult result = {false, nullptr, 0, 0, &id};
+        result.symbolInfo = Find(symbolName, result.chainIndex, result.symbolInfoIndex);
+        result.success = result.symbolInfo != nullptr;
+        return result;
+    }
 
-        if (scopeHashTable[chainIndex] != nullptr){
-            if (scopeHashTable[chainIndex]->getName() == symbolName){
-                symbolInfoIndex++;
-                SymbolInfo *toBeDeleted = scopeHashTable[chainIndex];
-                SymbolInfo *toBeLinked = toBeDeleted->nestSymbolInfo;
-                scopeHashTable[chainIndex] = toBeLinked;
+    SymbolTableResult Delete(string_view symbolName){
+        SymbolTableResult result = {false, nullptr, getChainIndex(symbolName), 0, &id};
+        SymbolInfo **link = &scopeHashTable[result.chainIndex];
+        while (*link != nullptr){
+            if ((*link)->getName() == symbolName){
+                SymbolInfo *toBeDeleted = *link;
+                *link = toBeDeleted->nestSymbolInfo;
                 delete toBeDeleted;
-                successfulDeletion = true;
-            }else{
-                SymbolInfo *chainIterator = scopeHashTable[chainIndex];
-                while (chainIterator->nestSymbolInfo != nullptr){
-                    symbolInfoIndex++;
-                    if (chainIterator->nestSymbolInfo->getName() == symbolName)
-                    {
-                        SymbolInfo *toBeDeleted = chainIterator->nestSymbolInfo;
-                        SymbolInfo *toBeLinked = toBeDeleted->nestSymbolInfo;
-                        chainIterator->nestSymbolInfo = toBeLinked;
-                        delete toBeDeleted;
-                        successfulDeletion = true;
-                        break;
-                    }else{
-                        chainIterator = chainIterator->nestSymbolInfo;
-                    }
-                }
+                result.success = true;
+                return result;
             }
+            link = &(*link)->nestSymbolInfo;
+            result.symbolInfoIndex++;
         }
-
-        if (successfulDeletion == true){
-            cout << "\tDeleted '" + symbolName + "' from position <" + to_string(chainIndex + 1) + ", " + to_string(symbolInfoIndex + 1) + "> of ScopeTable# " + id << endl;
-            return true;
-        }else{
-            cout << "\tNot found in the current ScopeTable# " + id << endl;
-            return false;
-        }
+        return result;
     }
 
-    void Print(){
-        cout << "\tScopeTable# " + id << endl;
-        for (int i = 0; i < totalBuckets; i++){
-            cout << "\t" << i + 1;
+    void Print(ostream &out = cout){
+        out << "\tScopeTable# " << id << '\n';
+        for (unsigned long long i = 0; i < totalBuckets; i++){
+            out << "\t" << i + 1;
             SymbolInfo *toBePrinted = scopeHashTable[i];
             while (toBePrinted != nullptr){
-                cout << " --> (" + toBePrinted->getName() + "," + toBePrinted->getType() + ")";
+                out << " --> (" << toBePrinted->getName() << "," << toBePrinted->getType() << ")";
                 toBePrinted = toBePrinted->nestSymbolInfo;
             }
-            cout << endl;
+            out << '\n';
         }
     }
 
-    string getId(){
+    const ScopeId &getId(){
         return id;
     }
 
     unsigned long long getNextChildSerial(){
         return nextChildSerial++;
     }
+
+    unsigned long long getTotalBuckets(){
+        return totalBuckets;
+    }
+
+    unsigned long long getChainLength(unsigned long long chainIndex){
+        unsigned long long chainLength = 0;
+        for (SymbolInfo *chainIterator = scopeHashTable[chainIndex]; chainIterator != nullptr; chainIterator = chainIterator->nestSymbolInfo){
+            chainLength++;
+        }
+        return chainLength;
+    }
 };
 
-class SymbolTable
+template <typename HashPolicy>
+class BasicSymbolTable
 {
 private:
+    typedef BasicScopeTable<HashPolicy> ScopeTable;
+
     ScopeTable *scopeTableList;
     ScopeTable *currentScopeTable;
     unsigned long long totalBuckets;
+    SymbolTableObserver *observer;
 
-    void createNewScopeTable(string newScopeTableId){
+    void createNewScopeTable(unsigned long long newScopeTableSerial){
         if(scopeTableList == nullptr){
-            scopeTableList = new ScopeTable(newScopeTableId, totalBuckets);
+            scopeTableList = new ScopeTable(newScopeTableSerial, totalBuckets);
             currentScopeTable = scopeTableList;
         }else{
-            ScopeTable *tmpScopeTabe = new ScopeTable(newScopeTableId, totalBuckets, currentScopeTable);
+            ScopeTable *tmpScopeTabe = new ScopeTable(newScopeTableSerial, totalBuckets, currentScopeTable);
             currentScopeTable = tmpScopeTabe;
         }
-        cout << "\tScopeTable# " + newScopeTableId + " created" << endl;
+        if (observer != nullptr){
+            observer->onScopeCreated(currentScopeTable->getId());
+        }
     }
 
     void deleteCurrentScope(){
-        cout << "\tScopeTable# " + currentScopeTable->getId() + " deleted" << endl;
+        if (observer != nullptr){
+            observer->onScopeDeleted(currentScopeTable->getId());
+        }
         ScopeTable *toBeDeleted = currentScopeTable;
         currentScopeTable = currentScopeTable->parentScope;
         delete toBeDeleted;
     }
 
 public:
-    SymbolTable(unsigned long long totalBuckets){
+    // The observer, if any, must outlive the table: the scopes still open are
+    // reported deleted from the destructor
+    BasicSymbolTable(unsigned long long totalBuckets, SymbolTableObserver *observer = nullptr){
         this->scopeTableList = nullptr;
         this->totalBuckets = totalBuckets;
-        string mainScopeTableId = "1";
-        createNewScopeTable(mainScopeTableId);
+        this->observer = observer;
+        createNewScopeTable(1);
     }
 
-    ~SymbolTable(){
+    ~BasicSymbolTable(){
         while(currentScopeTable != nullptr){
             deleteCurrentScope();
         }
     }
     
-    void EnterScope(){
-        string newScopeTableId = currentScopeTable->getId() + "." + to_string(currentScopeTable->getNextChildSerial());
-        createNewScopeTable(newScopeTableId);
+    // The returned id is valid until this scope is exited
+    const ScopeId &EnterScope(){
+        createNewScopeTable(currentScopeTable->getNextChildSerial());
+        return currentScopeTable->getId();
     }
 
-    void ExitScope(){
+    bool ExitScope(){
         if(currentScopeTable->parentScope != nullptr){
             deleteCurrentScope();
+            return true;
         }else{
-            cout << "\tScopeTable# " + currentScopeTable->getId() + " cannot be deleted" << endl;
+            if (observer != nullptr){
+                observer->onExitRefused(currentScopeTable->getId());
+            }
+            return false;
         }
     }
 
-    bool Insert(string symbolName, string symbolType){
-        return currentScopeTable->Insert(symbolName, symbolType);
+    SymbolTableResult Insert(string_view symbolName, string_view symbolType){
+        SymbolTableResult result = currentScopeTable->Insert(symbolName, symbolType);
+        if (observer != nullptr){
+            observer->onInsert(symbolName, result);
+        }
+        return result;
     }
 
-    bool Remove(string symbolName){
-        return currentScopeTable->Delete(symbolName);
+    SymbolTableResult Remove(string_view symbolName){
+        SymbolTableResult result = currentScopeTable->Delete(symbolName);
+        if (observer != nullptr){
+            observer->onRemove(symbolName, result);
+        }
+        return result;
     }
 
-    SymbolInfo* LookUp(string symbolName){
-        SymbolInfo* lookUpResult = nullptr;
+    SymbolTableResult LookUp(string_view symbolName){
+        SymbolTableResult result = {false, nullptr, 0, 0, nullptr};
         ScopeTable *tmpScopeTable = currentScopeTable;
         while (tmpScopeTable != nullptr)
         {
-            lookUpResult = tmpScopeTable->LookUp(symbolName);
-            if(lookUpResult){
-                return lookUpResult;
+            result = tmpScopeTable->LookUp(symbolName);
+            if(result.success){
+                break;
             }else{
                 tmpScopeTable = tmpScopeTable->parentScope;
             }
         }
-        cout << "\t'" + symbolName + "'" + " not found in any of the ScopeTables" << endl;
-        return lookUpResult;
-        
+        if (!result.success){
+            result.scopeId = nullptr;
+        }
+        if (observer != nullptr){
+            observer->onLookUp(symbolName, result);
+        }
+        return result;
     }
 
-    void PrintCurrentScopeTable(){
-        currentScopeTable->Print();
+    void PrintCurrentScopeTable(ostream &out = cout){
+        currentScopeTable->Print(out);
     }
 
-    void PrintAllScopeTable(){
+    void PrintAllScopeTable(ostream &out = cout){
         ScopeTable *tmpScopeTable = currentScopeTable;
         while (tmpScopeTable != nullptr){
-            tmpScopeTable->Print();
+            tmpScopeTable->Print(out);
             tmpScopeTable = tmpScopeTable->parentScope;
         }
     }
-};
\ No newline at end of file
+};
+
+typedef BasicScopeTable<SdbmHash> ScopeTable;
+typedef BasicSymbolTable<SdbmHash> SymbolTable;
@@ -2,6 +2,9 @@
 
 #include <iostream>
 #include <fstream>
+#include <utility>
+#include <vector>
+#include "../SymbolTable/2005021_HashPolicy.h"
 
 using namespace std;
 
@@ -19,6 +22,7 @@ public:
         this->type = type;
         this->nestSymbolInfo = nullptr;
     }
+    virtual ~SymbolInfo() {}
     void setName(string name)
     {
         this->name = name;
@@ -232,49 +236,39 @@ public:
     }
 };
 
-class ScopeTable
+template <typename HashPolicy>
+class BasicScopeTable
 {
 private:
     string id;
     unsigned long long nextChildSerial;
     unsigned long long totalBuckets;
     SymbolInfo **scopeHashTable;
+    HashPolicy hashPolicy;
 
-    unsigned long long Hash(string str)
-    {
-        unsigned long long hash = 0;
-        unsigned long long i = 0;
-        unsigned long long len = str.length();
-
-        for (i = 0; i < len; i++)
-        {
-            hash = (str[i]) + (hash << 6) + (hash << 16) - hash;
-        }
-        return hash;
-    }
     unsigned long long getChainIndex(string SymbolName)
     {
-        return Hash(SymbolName) % totalBuckets;
+        return hashPolicy(SymbolName) % totalBuckets;
     }
 
 public:
-    ScopeTable *parentScope;
-    ScopeTable(string id, unsigned long long totalBuckets, ScopeTable *parentScope = nullptr)
+    BasicScopeTable *parentScope;
+    BasicScopeTable(string id, unsigned long long totalBuckets, BasicScopeTable *parentScope = nullptr)
     {
         this->id = id;
         this->totalBuckets = totalBuckets;
         this->parentScope = parentScope;
         this->scopeHashTable = new SymbolInfo *[totalBuckets];
-        for (int i = 0; i < totalBuckets; i++)
+        for (unsigned long long i = 0; i < totalBuckets; i++)
         {
             scopeHashTable[i] = nullptr;
         }
         this->nextChildSerial = 1;
     }
-    ~ScopeTable()
+    ~BasicScopeTable()
     {
         parentScope = nullptr;
-        for (int i = 0; i < totalBuckets; i++)
+        for (unsigned long long i = 0; i < totalBuckets; i++)
         {
             SymbolInfo *chainRoot = scopeHashTable[i];
             scopeHashTable[i] = nullptr;
@@ -412,7 +406,7 @@ public:
     {
         string scopeTable = "";
         scopeTable += "\tScopeTable# " + id + "\n";
-        for (int i = 0; i < totalBuckets; i++)
+        for (unsigned long long i = 0; i < totalBuckets; i++)
         {
             SymbolInfo *toBePrinted = scopeHashTable[i];
             if (toBePrinted != nullptr)
@@ -438,23 +432,26 @@ public:
     }
 };
 
-class SymbolTable
+template <typename HashPolicy>
+class BasicSymbolTable
 {
 private:
+    typedef BasicScopeTable<HashPolicy> ScopeTable;
+
     int latestScopeTableId;
     ScopeTable *scopeTableList;
     ScopeTable *currentScopeTable;
     unsigned long long totalBuckets;
 
 public:
-    SymbolTable(unsigned long long totalBuckets)
+    BasicSymbolTable(unsigned long long totalBuckets)
     {
         this->latestScopeTableId = 1;
         this->scopeTableList = nullptr;
         this->totalBuckets = totalBuckets;
         createNewScopeTable(to_string(latestScopeTableId));
     }
-    ~SymbolTable()
+    ~BasicSymbolTable()
     {
         while (currentScopeTable != nullptr)
         {
@@ -539,6 +536,9 @@ public:
     }
 };
 
+typedef BasicScopeTable<SdbmHash> ScopeTable;
+typedef BasicSymbolTable<SdbmHash> SymbolTable;
+
 class ASTNode
 {
 public:
@@ -744,26 +744,39 @@ public:
     {
         printTree(file, root, 0);
     }
+    // Pre-order walk with an explicit stack holding, for every open node, the
+    // next child still to be printed, so long statement lists cannot overflow
+    // the call stack
     void printTree(ofstream &file, ASTNode *node, int depth)
     {
-        if (node == nullptr)
-        {
-            return;
-        }
-        for (int i = 0; i < depth; i++)
+        vector<pair<ASTNodeList *, int>> pending;
+        ASTNodeList rootEntry(node);
+        pending.push_back(make_pair(&rootEntry, depth));
+        while (!pending.empty())
         {
-            file << " ";
-        }
-        file << node->toString() << endl;
-        ASTInternalNode *internalNode = dynamic_cast<ASTInternalNode *>(node);
-        if (internalNode != nullptr)
-        {
-            ASTNodeList *children = internalNode->getChildren();
-            while (children != nullptr)
+            ASTNodeList *entry = pending.back().first;
+            int entryDepth = pending.back().second;
+            if (entry == nullptr)
             {
-                printTree(file, children->getNodePtr(), depth + 1);
-                children = children->nextNodePtr;
+                pending.pop_back();
+                continue;
+            }
+            pending.back().first = entry->nextNodePtr;
+            ASTNode *current = entry->getNodePtr();
+            if (current == nullptr)
+            {
+                continue;
+            }
+            for (int i = 0; i < entryDepth; i++)
+            {
+                file << " ";
+            }
+            file << current->toString() << endl;
+            ASTInternalNode *internalNode = dynamic_cast<ASTInternalNode *>(current);
+            if (internalNode != nullptr)
+            {
+                pending.push_back(make_pair(internalNode->getChildren(), entryDepth + 1));
             }
         }
     }
-};
\ No newline at end of file
+};